@@ -26,6 +26,38 @@
 
 #include  "miniz.h"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/* SIMD CRC-32 and Adler-32: x86 kernels are picked at runtime (CPUID), ARM ones are used when the compiler targets them. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define MINIZ_X86_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MINIZ_SSE2_TARGET
+#define MINIZ_PCLMUL_TARGET
+#define MINIZ_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define MINIZ_SSE2_TARGET __attribute__((target("sse2")))
+#define MINIZ_PCLMUL_TARGET __attribute__((target("sse2,pclmul")))
+#define MINIZ_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#include <immintrin.h>
+#else
+#if defined(__ARM_FEATURE_CRC32)
+#define MINIZ_CRC32_ARMV8
+#include <arm_acle.h>
+#endif
+#if defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define MINIZ_ARM_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 typedef unsigned char mz_validate_uint16[sizeof(mz_uint16) == 2 ? 1 : -1];
 typedef unsigned char mz_validate_uint32[sizeof(mz_uint32) == 4 ? 1 : -1];
 typedef unsigned char mz_validate_uint64[sizeof(mz_uint64) == 8 ? 1 : -1];
@@ -36,12 +68,170 @@ extern "C" {
 
 /* ------------------- zlib-style API's */
 
+#if defined(MINIZ_X86_SIMD)
+enum
+{
+    MZ_X86_SSE2 = 1,
+    MZ_X86_PCLMUL = 2,
+    MZ_X86_AVX2 = 4
+};
+
+static mz_uint mz_x86_cpu_features(void)
+{
+    mz_uint features = 0;
+    unsigned int max_leaf, ecx, edx, ebx7 = 0, xcr0 = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    max_leaf = (unsigned int)info[0];
+    __cpuid(info, 1);
+    ecx = (unsigned int)info[2];
+    edx = (unsigned int)info[3];
+    if (max_leaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        ebx7 = (unsigned int)info[1];
+    }
+    if (ecx & (1 << 27))
+        xcr0 = (unsigned int)_xgetbv(0);
+#else
+    unsigned int eax, ebx, ecx7, edx7;
+    max_leaf = __get_cpuid_max(0, NULL);
+    if (max_leaf < 1)
+        return 0;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (max_leaf >= 7)
+        __cpuid_count(7, 0, eax, ebx7, ecx7, edx7);
+    if (ecx & (1 << 27))
+        __asm__ __volatile__("xgetbv" : "=a"(xcr0), "=d"(edx7) : "c"(0));
+#endif
+    if (edx & (1 << 26))
+        features |= MZ_X86_SSE2;
+    if ((edx & (1 << 26)) && (ecx & (1 << 1)))
+        features |= MZ_X86_PCLMUL;
+    /* AVX2 also needs the OS to save the YMM registers (OSXSAVE set and XCR0 bits 1 and 2) */
+    if ((ecx & (1 << 27)) && (ecx & (1 << 28)) && ((xcr0 & 6) == 6) && (ebx7 & (1 << 5)))
+        features |= MZ_X86_AVX2;
+    return features;
+}
+#endif /* MINIZ_X86_SIMD */
+
+/* The vectorized Adler-32 kernels below take 16 or 32 bytes per step and fold the bytes' positions into s2 with multiply-adds. */
+/* They stop at multiples of their width, leaving the rest to the scalar loop, and reduce modulo 65521 at most every 5552 bytes like it. */
+#if defined(MINIZ_X86_SIMD)
+static MINIZ_SSE2_TARGET mz_uint32 mz_adler32_hsum_sse2(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (mz_uint32)_mm_cvtsi128_si32(v);
+}
+
+static MINIZ_SSE2_TARGET const mz_uint8 *mz_adler32_sse2(mz_uint32 *pS1, mz_uint32 *pS2, const mz_uint8 *ptr, size_t buf_len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights_low = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i weights_high = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+
+    while (buf_len >= 16)
+    {
+        size_t block_len = MZ_MIN(buf_len, 5552) & ~(size_t)15;
+        __m128i vs1 = _mm_cvtsi32_si128((int)*pS1), vs2 = _mm_cvtsi32_si128((int)*pS2), vs1_sum = zero;
+        buf_len -= block_len;
+        for (; block_len; block_len -= 16, ptr += 16)
+        {
+            const __m128i bytes = _mm_loadu_si128((const __m128i *)ptr);
+            vs1_sum = _mm_add_epi32(vs1_sum, vs1);
+            vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes, zero));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weights_low));
+            vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weights_high));
+        }
+        vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vs1_sum, 4));
+        *pS1 = mz_adler32_hsum_sse2(vs1) % 65521U;
+        *pS2 = mz_adler32_hsum_sse2(vs2) % 65521U;
+    }
+    return ptr;
+}
+
+static MINIZ_AVX2_TARGET const mz_uint8 *mz_adler32_avx2(mz_uint32 *pS1, mz_uint32 *pS2, const mz_uint8 *ptr, size_t buf_len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                             16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    while (buf_len >= 32)
+    {
+        size_t block_len = MZ_MIN(buf_len, 5552) & ~(size_t)31;
+        __m256i vs1 = _mm256_setr_epi32((int)*pS1, 0, 0, 0, 0, 0, 0, 0);
+        __m256i vs2 = _mm256_setr_epi32((int)*pS2, 0, 0, 0, 0, 0, 0, 0);
+        __m256i vs1_sum = zero;
+        buf_len -= block_len;
+        for (; block_len; block_len -= 32, ptr += 32)
+        {
+            const __m256i bytes = _mm256_loadu_si256((const __m256i *)ptr);
+            vs1_sum = _mm256_add_epi32(vs1_sum, vs1);
+            vs1 = _mm256_add_epi32(vs1, _mm256_sad_epu8(bytes, zero));
+            vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+        }
+        vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(vs1_sum, 5));
+        *pS1 = mz_adler32_hsum_sse2(_mm_add_epi32(_mm256_castsi256_si128(vs1), _mm256_extracti128_si256(vs1, 1))) % 65521U;
+        *pS2 = mz_adler32_hsum_sse2(_mm_add_epi32(_mm256_castsi256_si128(vs2), _mm256_extracti128_si256(vs2, 1))) % 65521U;
+    }
+    return ptr;
+}
+#endif /* MINIZ_X86_SIMD */
+
+#if defined(MINIZ_ARM_NEON)
+static const mz_uint8 *mz_adler32_neon(mz_uint32 *pS1, mz_uint32 *pS2, const mz_uint8 *ptr, size_t buf_len)
+{
+    static const mz_uint8 s_weights[16] = { 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+    const uint8x8_t weights_low = vld1_u8(s_weights), weights_high = vld1_u8(s_weights + 8);
+
+    while (buf_len >= 16)
+    {
+        size_t block_len = MZ_MIN(buf_len, 5552) & ~(size_t)15;
+        uint32x4_t vs1 = vsetq_lane_u32(*pS1, vdupq_n_u32(0), 0), vs2 = vsetq_lane_u32(*pS2, vdupq_n_u32(0), 0), vs1_sum = vdupq_n_u32(0);
+        buf_len -= block_len;
+        for (; block_len; block_len -= 16, ptr += 16)
+        {
+            const uint8x16_t bytes = vld1q_u8(ptr);
+            vs1_sum = vaddq_u32(vs1_sum, vs1);
+            vs1 = vpadalq_u16(vs1, vpaddlq_u8(bytes));
+            vs2 = vpadalq_u16(vs2, vmull_u8(vget_low_u8(bytes), weights_low));
+            vs2 = vpadalq_u16(vs2, vmull_u8(vget_high_u8(bytes), weights_high));
+        }
+        vs2 = vaddq_u32(vs2, vshlq_n_u32(vs1_sum, 4));
+        *pS1 = vaddvq_u32(vs1) % 65521U;
+        *pS2 = vaddvq_u32(vs2) % 65521U;
+    }
+    return ptr;
+}
+#endif /* MINIZ_ARM_NEON */
+
 mz_ulong mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len)
 {
     mz_uint32 i, s1 = (mz_uint32)(adler & 0xffff), s2 = (mz_uint32)(adler >> 16);
-    size_t block_len = buf_len % 5552;
+    size_t block_len;
     if (!ptr)
         return MZ_ADLER32_INIT;
+#if defined(MINIZ_X86_SIMD)
+    {
+        static const mz_uint s_cpu_features = mz_x86_cpu_features();
+        const mz_uint8 *pEnd = ptr + buf_len;
+        if (s_cpu_features & MZ_X86_AVX2)
+            ptr = mz_adler32_avx2(&s1, &s2, ptr, buf_len);
+        else if (s_cpu_features & MZ_X86_SSE2)
+            ptr = mz_adler32_sse2(&s1, &s2, ptr, buf_len);
+        buf_len = pEnd - ptr;
+    }
+#elif defined(MINIZ_ARM_NEON)
+    {
+        const mz_uint8 *pEnd = ptr + buf_len;
+        ptr = mz_adler32_neon(&s1, &s2, ptr, buf_len);
+        buf_len = pEnd - ptr;
+    }
+#endif
+    block_len = buf_len % 5552;
     while (buf_len)
     {
         for (i = 0; i + 7 < block_len; i += 8, ptr += 8)
@@ -83,75 +273,540 @@ mz_ulong mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len)
         return ~crcu32;
     }
 #else
-/* Faster, but larger CPU cache footprint.
- */
-mz_ulong mz_crc32(mz_ulong crc, const mz_uint8 *ptr, size_t buf_len)
-{
-    static const mz_uint32 s_crc_table[256] =
-        {
-          0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535,
-          0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD,
-          0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D,
-          0x6DDDE4EB, 0xF4D4B551, 0x83D385C7, 0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC,
-          0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4,
-          0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
-          0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59, 0x26D930AC,
-          0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
-          0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB,
-          0xB6662D3D, 0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F,
-          0x9FBFE4A5, 0xE8B8D433, 0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB,
-          0x086D3D2D, 0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
-          0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA,
-          0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65, 0x4DB26158, 0x3AB551CE,
-          0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A,
-          0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
-          0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409,
-          0xCE61E49F, 0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
-          0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739,
-          0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8,
-          0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1, 0xF00F9344, 0x8708A3D2, 0x1E01F268,
-          0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0,
-          0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8,
-          0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
-          0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF,
-          0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703,
-          0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7,
-          0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D, 0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A,
-          0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE,
-          0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
-          0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777, 0x88085AE6,
-          0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
-          0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D,
-          0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5,
-          0x47B2CF7F, 0x30B5FFE9, 0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605,
-          0xCDD70693, 0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
-          0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+/* Slicing-by-8: eight bytes per step through eight tables, each advancing the CRC by one more byte (s_crc_table[0] is the classic byte-at-a-time table). */
+static mz_uint32 mz_crc32_slice_by_8(mz_uint32 crc32, const mz_uint8 *pByte_buf, size_t buf_len)
+{
+    static const mz_uint32 s_crc_table[8][256] =
+        {
+          {
+            0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535,
+            0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD,
+            0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D,
+            0x6DDDE4EB, 0xF4D4B551, 0x83D385C7, 0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC,
+            0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4,
+            0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+            0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59, 0x26D930AC,
+            0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+            0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB,
+            0xB6662D3D, 0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F,
+            0x9FBFE4A5, 0xE8B8D433, 0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB,
+            0x086D3D2D, 0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+            0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA,
+            0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65, 0x4DB26158, 0x3AB551CE,
+            0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A,
+            0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+            0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409,
+            0xCE61E49F, 0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+            0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739,
+            0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8,
+            0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1, 0xF00F9344, 0x8708A3D2, 0x1E01F268,
+            0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0,
+            0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8,
+            0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+            0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF,
+            0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703,
+            0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7,
+            0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D, 0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A,
+            0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE,
+            0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+            0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777, 0x88085AE6,
+            0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+            0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D,
+            0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5,
+            0x47B2CF7F, 0x30B5FFE9, 0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605,
+            0xCDD70693, 0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+            0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+          },
+          {
+            0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445, 0x565AA786,
+            0x4F4196C7, 0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB, 0xACB54F0C, 0xB5AE7E4D,
+            0x9E832D8E, 0x87981CCF, 0x4AC21251, 0x53D92310, 0x78F470D3, 0x61EF4192, 0x2EAED755,
+            0x37B5E614, 0x1C98B5D7, 0x05838496, 0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A,
+            0xE6775D5D, 0xFF6C6C1C, 0xD4413FDF, 0xCD5A0E9E, 0x958424A2, 0x8C9F15E3, 0xA7B24620,
+            0xBEA97761, 0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265, 0x5D5DAEAA, 0x44469FEB,
+            0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D, 0xDF4636F3,
+            0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6, 0x891C9175, 0x9007A034,
+            0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38, 0x73F379FF, 0x6AE848BE, 0x41C51B7D,
+            0x58DE2A3C, 0xF0794F05, 0xE9627E44, 0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40,
+            0xA623E883, 0xBF38D9C2, 0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009,
+            0x45D73148, 0x6EFA628B, 0x77E153CA, 0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97,
+            0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93, 0x7262D75C, 0x6B79E61D, 0x4054B5DE,
+            0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B, 0x65FD6BA7, 0x7CE65AE6,
+            0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2, 0x33A7CC21, 0x2ABCFD60, 0xAD24E1AF,
+            0xB43FD0EE, 0x9F12832D, 0x8609B26C, 0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768,
+            0x2F3F79F6, 0x362448B7, 0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70,
+            0x607EEF31, 0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB,
+            0xB1BC5478, 0xA8A76539, 0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88, 0x5FEF5D4F,
+            0x46F46C0E, 0x6DD93FCD, 0x74C20E8C, 0xF35A1243, 0xEA412302, 0xC16C70C1, 0xD8774180,
+            0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484, 0x71418A1A, 0x685ABB5B, 0x4377E898,
+            0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F, 0x271B2D9C, 0x3E001CDD, 0xB9980012, 0xA0833153,
+            0x8BAE6290, 0x92B553D1, 0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5, 0xAE07BCE9,
+            0xB71C8DA8, 0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+            0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4, 0x30849167,
+            0x299FA026, 0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B, 0x80A96BBC, 0x99B25AFD,
+            0xB29F093E, 0xAB84387F, 0x2C1C24B0, 0x350715F1, 0x1E2A4632, 0x07317773, 0x4870E1B4,
+            0x516BD0F5, 0x7A468336, 0x635DB277, 0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D,
+            0xAF96124A, 0xB68D230B, 0x9DA070C8, 0x84BB4189, 0x03235D46, 0x1A386C07, 0x31153FC4,
+            0x280E0E85, 0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81, 0x8138C51F, 0x9823F45E,
+            0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8, 0x49E14F17,
+            0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52, 0x1FBBE891, 0x06A0D9D0,
+            0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F, 0x3A1236E8, 0x230907A9, 0x0824546A,
+            0x113F652B, 0x96A779E4, 0x8FBC48A5, 0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1,
+            0xC0FDDE62, 0xD9E6EF23, 0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9,
+            0x69CB15F8, 0x42E6463B, 0x5BFD777A, 0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876,
+            0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+          },
+          {
+            0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB, 0x048D7CB2,
+            0x054F1685, 0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1, 0x091AF964, 0x08D89353,
+            0x0A9E2D0A, 0x0B5C473D, 0x1C26A370, 0x1DE4C947, 0x1FA2771E, 0x1E601D29, 0x1B2F0BAC,
+            0x1AED619B, 0x18ABDFC2, 0x1969B5F5, 0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91,
+            0x153C5A14, 0x14FE3023, 0x16B88E7A, 0x177AE44D, 0x384D46E0, 0x398F2CD7, 0x3BC9928E,
+            0x3A0BF8B9, 0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065, 0x365E1758, 0x379C7D6F,
+            0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD, 0x246BE590,
+            0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B, 0x20E69922, 0x2124F315,
+            0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71, 0x2D711CF4, 0x2CB376C3, 0x2EF5C89A,
+            0x2F37A2AD, 0x709A8DC0, 0x7158E7F7, 0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B,
+            0x7417F172, 0x75D59B45, 0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4,
+            0x78421E93, 0x7A04A0CA, 0x7BC6CAFD, 0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9,
+            0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835, 0x62AF7F08, 0x636D153F, 0x612BAB66,
+            0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D, 0x48D7CB20, 0x4915A117,
+            0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB, 0x4C5AB792, 0x4D98DDA5, 0x46C49A98,
+            0x4706F0AF, 0x45404EF6, 0x448224C1, 0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D,
+            0x54F16850, 0x55330267, 0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2,
+            0x51BE7ED5, 0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03,
+            0x5E6F455A, 0x5FAD2F6D, 0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9, 0xE63CB35C,
+            0xE7FED96B, 0xE5B86732, 0xE47A0D05, 0xEF264A38, 0xEEE4200F, 0xECA29E56, 0xED60F461,
+            0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD, 0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E,
+            0xFF5506A9, 0xFA1A102C, 0xFBD87A1B, 0xF99EC442, 0xF85CAE75, 0xF300E948, 0xF2C2837F,
+            0xF0843D26, 0xF1465711, 0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD, 0xD9785D60,
+            0xD8BA3757, 0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+            0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33, 0xD3E6706A,
+            0xD2241A5D, 0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049, 0xC25756CC, 0xC3953CFB,
+            0xC1D382A2, 0xC011E895, 0xCB4DAFA8, 0xCA8FC59F, 0xC8C97BC6, 0xC90B11F1, 0xCC440774,
+            0xCD866D43, 0xCFC0D31A, 0xCE02B92D, 0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819,
+            0x96A63E9C, 0x976454AB, 0x9522EAF2, 0x94E080C5, 0x9FBCC7F8, 0x9E7EADCF, 0x9C381396,
+            0x9DFA79A1, 0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D, 0x8D893530, 0x8C4B5F07,
+            0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5, 0x839A6488,
+            0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663, 0x8717183A, 0x86D5720D,
+            0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9, 0xAEEB787C, 0xAF29124B, 0xAD6FAC12,
+            0xACADC625, 0xA7F18118, 0xA633EB2F, 0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3,
+            0xA37CFDAA, 0xA2BE979D, 0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C,
+            0xB30FB13B, 0xB1490F62, 0xB08B6555, 0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31,
+            0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+          },
+          {
+            0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032, 0x256B5FDC,
+            0x9DD738B9, 0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701, 0x4AD6BFB8, 0xF26AD8DD,
+            0xE0DF7733, 0x58631056, 0x5019579F, 0xE8A530FA, 0xFA109F14, 0x42ACF871, 0xDF7BC0C8,
+            0x67C7A7AD, 0x75720843, 0xCDCE6F26, 0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E,
+            0x1ACFE827, 0xA2738F42, 0xB0C620AC, 0x087A47C9, 0xA032AF3E, 0x188EC85B, 0x0A3B67B5,
+            0xB28700D0, 0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787, 0x658687D1, 0xDD3AE0B4,
+            0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68, 0xF02BF8A1,
+            0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893, 0xD540A77D, 0x6DFCC018,
+            0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0, 0xBAFD4719, 0x0241207C, 0x10F48F92,
+            0xA848E8F7, 0x9B14583D, 0x23A83F58, 0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F,
+            0xBE7F07E1, 0x06C36084, 0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785,
+            0x697E80E0, 0x7BCB2F0E, 0xC377486B, 0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C,
+            0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B, 0x0EB9274D, 0xB6054028, 0xA4B0EFC6,
+            0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4, 0x3B26F703, 0x839A9066,
+            0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731, 0x1E4DA8DF, 0xA6F1CFBA, 0xFE92DFEC,
+            0x462EB889, 0x549B1767, 0xEC277002, 0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755,
+            0x6B3FA09C, 0xD383C7F9, 0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40,
+            0xF6E89825, 0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841,
+            0x8BE0D7AF, 0x335CB0CA, 0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5, 0x623B216C,
+            0xDA874609, 0xC832E9E7, 0x708E8E82, 0x28ED9ED4, 0x9051F9B1, 0x82E4565F, 0x3A58313A,
+            0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D, 0xBD40E1A4, 0x05FC86C1, 0x1749292F,
+            0xAFF54E4A, 0x322276F3, 0x8A9E1196, 0x982BBE78, 0x2097D91D, 0x78F4C94B, 0xC048AE2E,
+            0xD2FD01C0, 0x6A4166A5, 0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2, 0x4D6B1905,
+            0xF5D77E60, 0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+            0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8, 0xADB46E36,
+            0x15080953, 0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174, 0x9210D9CD, 0x2AACBEA8,
+            0x38191146, 0x80A57623, 0xD8C66675, 0x607A0110, 0x72CFAEFE, 0xCA73C99B, 0x57A4F122,
+            0xEF189647, 0xFDAD39A9, 0x45115ECC, 0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8,
+            0xF92F7951, 0x41931E34, 0x5326B1DA, 0xEB9AD6BF, 0xB3F9C6E9, 0x0B45A18C, 0x19F00E62,
+            0xA14C6907, 0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50, 0x2654B999, 0x9EE8DEFC,
+            0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120, 0xE3E09176,
+            0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144, 0xC68BCEAA, 0x7E37A9CF,
+            0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6, 0x591DD66F, 0xE1A1B10A, 0xF3141EE4,
+            0x4BA87981, 0x13CB69D7, 0xAB770EB2, 0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5,
+            0x36A0360B, 0x8E1C516E, 0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0,
+            0xB1B8E695, 0xA30D497B, 0x1BB12E1E, 0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6,
+            0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+          },
+          {
+            0x00000000, 0x3D6029B0, 0x7AC05360, 0x47A07AD0, 0xF580A6C0, 0xC8E08F70, 0x8F40F5A0,
+            0xB220DC10, 0x30704BC1, 0x0D106271, 0x4AB018A1, 0x77D03111, 0xC5F0ED01, 0xF890C4B1,
+            0xBF30BE61, 0x825097D1, 0x60E09782, 0x5D80BE32, 0x1A20C4E2, 0x2740ED52, 0x95603142,
+            0xA80018F2, 0xEFA06222, 0xD2C04B92, 0x5090DC43, 0x6DF0F5F3, 0x2A508F23, 0x1730A693,
+            0xA5107A83, 0x98705333, 0xDFD029E3, 0xE2B00053, 0xC1C12F04, 0xFCA106B4, 0xBB017C64,
+            0x866155D4, 0x344189C4, 0x0921A074, 0x4E81DAA4, 0x73E1F314, 0xF1B164C5, 0xCCD14D75,
+            0x8B7137A5, 0xB6111E15, 0x0431C205, 0x3951EBB5, 0x7EF19165, 0x4391B8D5, 0xA121B886,
+            0x9C419136, 0xDBE1EBE6, 0xE681C256, 0x54A11E46, 0x69C137F6, 0x2E614D26, 0x13016496,
+            0x9151F347, 0xAC31DAF7, 0xEB91A027, 0xD6F18997, 0x64D15587, 0x59B17C37, 0x1E1106E7,
+            0x23712F57, 0x58F35849, 0x659371F9, 0x22330B29, 0x1F532299, 0xAD73FE89, 0x9013D739,
+            0xD7B3ADE9, 0xEAD38459, 0x68831388, 0x55E33A38, 0x124340E8, 0x2F236958, 0x9D03B548,
+            0xA0639CF8, 0xE7C3E628, 0xDAA3CF98, 0x3813CFCB, 0x0573E67B, 0x42D39CAB, 0x7FB3B51B,
+            0xCD93690B, 0xF0F340BB, 0xB7533A6B, 0x8A3313DB, 0x0863840A, 0x3503ADBA, 0x72A3D76A,
+            0x4FC3FEDA, 0xFDE322CA, 0xC0830B7A, 0x872371AA, 0xBA43581A, 0x9932774D, 0xA4525EFD,
+            0xE3F2242D, 0xDE920D9D, 0x6CB2D18D, 0x51D2F83D, 0x167282ED, 0x2B12AB5D, 0xA9423C8C,
+            0x9422153C, 0xD3826FEC, 0xEEE2465C, 0x5CC29A4C, 0x61A2B3FC, 0x2602C92C, 0x1B62E09C,
+            0xF9D2E0CF, 0xC4B2C97F, 0x8312B3AF, 0xBE729A1F, 0x0C52460F, 0x31326FBF, 0x7692156F,
+            0x4BF23CDF, 0xC9A2AB0E, 0xF4C282BE, 0xB362F86E, 0x8E02D1DE, 0x3C220DCE, 0x0142247E,
+            0x46E25EAE, 0x7B82771E, 0xB1E6B092, 0x8C869922, 0xCB26E3F2, 0xF646CA42, 0x44661652,
+            0x79063FE2, 0x3EA64532, 0x03C66C82, 0x8196FB53, 0xBCF6D2E3, 0xFB56A833, 0xC6368183,
+            0x74165D93, 0x49767423, 0x0ED60EF3, 0x33B62743, 0xD1062710, 0xEC660EA0, 0xABC67470,
+            0x96A65DC0, 0x248681D0, 0x19E6A860, 0x5E46D2B0, 0x6326FB00, 0xE1766CD1, 0xDC164561,
+            0x9BB63FB1, 0xA6D61601, 0x14F6CA11, 0x2996E3A1, 0x6E369971, 0x5356B0C1, 0x70279F96,
+            0x4D47B626, 0x0AE7CCF6, 0x3787E546, 0x85A73956, 0xB8C710E6, 0xFF676A36, 0xC2074386,
+            0x4057D457, 0x7D37FDE7, 0x3A978737, 0x07F7AE87, 0xB5D77297, 0x88B75B27, 0xCF1721F7,
+            0xF2770847, 0x10C70814, 0x2DA721A4, 0x6A075B74, 0x576772C4, 0xE547AED4, 0xD8278764,
+            0x9F87FDB4, 0xA2E7D404, 0x20B743D5, 0x1DD76A65, 0x5A7710B5, 0x67173905, 0xD537E515,
+            0xE857CCA5, 0xAFF7B675, 0x92979FC5, 0xE915E8DB, 0xD475C16B, 0x93D5BBBB, 0xAEB5920B,
+            0x1C954E1B, 0x21F567AB, 0x66551D7B, 0x5B3534CB, 0xD965A31A, 0xE4058AAA, 0xA3A5F07A,
+            0x9EC5D9CA, 0x2CE505DA, 0x11852C6A, 0x562556BA, 0x6B457F0A, 0x89F57F59, 0xB49556E9,
+            0xF3352C39, 0xCE550589, 0x7C75D999, 0x4115F029, 0x06B58AF9, 0x3BD5A349, 0xB9853498,
+            0x84E51D28, 0xC34567F8, 0xFE254E48, 0x4C059258, 0x7165BBE8, 0x36C5C138, 0x0BA5E888,
+            0x28D4C7DF, 0x15B4EE6F, 0x521494BF, 0x6F74BD0F, 0xDD54611F, 0xE03448AF, 0xA794327F,
+            0x9AF41BCF, 0x18A48C1E, 0x25C4A5AE, 0x6264DF7E, 0x5F04F6CE, 0xED242ADE, 0xD044036E,
+            0x97E479BE, 0xAA84500E, 0x4834505D, 0x755479ED, 0x32F4033D, 0x0F942A8D, 0xBDB4F69D,
+            0x80D4DF2D, 0xC774A5FD, 0xFA148C4D, 0x78441B9C, 0x4524322C, 0x028448FC, 0x3FE4614C,
+            0x8DC4BD5C, 0xB0A494EC, 0xF704EE3C, 0xCA64C78C
+          },
+          {
+            0x00000000, 0xCB5CD3A5, 0x4DC8A10B, 0x869472AE, 0x9B914216, 0x50CD91B3, 0xD659E31D,
+            0x1D0530B8, 0xEC53826D, 0x270F51C8, 0xA19B2366, 0x6AC7F0C3, 0x77C2C07B, 0xBC9E13DE,
+            0x3A0A6170, 0xF156B2D5, 0x03D6029B, 0xC88AD13E, 0x4E1EA390, 0x85427035, 0x9847408D,
+            0x531B9328, 0xD58FE186, 0x1ED33223, 0xEF8580F6, 0x24D95353, 0xA24D21FD, 0x6911F258,
+            0x7414C2E0, 0xBF481145, 0x39DC63EB, 0xF280B04E, 0x07AC0536, 0xCCF0D693, 0x4A64A43D,
+            0x81387798, 0x9C3D4720, 0x57619485, 0xD1F5E62B, 0x1AA9358E, 0xEBFF875B, 0x20A354FE,
+            0xA6372650, 0x6D6BF5F5, 0x706EC54D, 0xBB3216E8, 0x3DA66446, 0xF6FAB7E3, 0x047A07AD,
+            0xCF26D408, 0x49B2A6A6, 0x82EE7503, 0x9FEB45BB, 0x54B7961E, 0xD223E4B0, 0x197F3715,
+            0xE82985C0, 0x23755665, 0xA5E124CB, 0x6EBDF76E, 0x73B8C7D6, 0xB8E41473, 0x3E7066DD,
+            0xF52CB578, 0x0F580A6C, 0xC404D9C9, 0x4290AB67, 0x89CC78C2, 0x94C9487A, 0x5F959BDF,
+            0xD901E971, 0x125D3AD4, 0xE30B8801, 0x28575BA4, 0xAEC3290A, 0x659FFAAF, 0x789ACA17,
+            0xB3C619B2, 0x35526B1C, 0xFE0EB8B9, 0x0C8E08F7, 0xC7D2DB52, 0x4146A9FC, 0x8A1A7A59,
+            0x971F4AE1, 0x5C439944, 0xDAD7EBEA, 0x118B384F, 0xE0DD8A9A, 0x2B81593F, 0xAD152B91,
+            0x6649F834, 0x7B4CC88C, 0xB0101B29, 0x36846987, 0xFDD8BA22, 0x08F40F5A, 0xC3A8DCFF,
+            0x453CAE51, 0x8E607DF4, 0x93654D4C, 0x58399EE9, 0xDEADEC47, 0x15F13FE2, 0xE4A78D37,
+            0x2FFB5E92, 0xA96F2C3C, 0x6233FF99, 0x7F36CF21, 0xB46A1C84, 0x32FE6E2A, 0xF9A2BD8F,
+            0x0B220DC1, 0xC07EDE64, 0x46EAACCA, 0x8DB67F6F, 0x90B34FD7, 0x5BEF9C72, 0xDD7BEEDC,
+            0x16273D79, 0xE7718FAC, 0x2C2D5C09, 0xAAB92EA7, 0x61E5FD02, 0x7CE0CDBA, 0xB7BC1E1F,
+            0x31286CB1, 0xFA74BF14, 0x1EB014D8, 0xD5ECC77D, 0x5378B5D3, 0x98246676, 0x852156CE,
+            0x4E7D856B, 0xC8E9F7C5, 0x03B52460, 0xF2E396B5, 0x39BF4510, 0xBF2B37BE, 0x7477E41B,
+            0x6972D4A3, 0xA22E0706, 0x24BA75A8, 0xEFE6A60D, 0x1D661643, 0xD63AC5E6, 0x50AEB748,
+            0x9BF264ED, 0x86F75455, 0x4DAB87F0, 0xCB3FF55E, 0x006326FB, 0xF135942E, 0x3A69478B,
+            0xBCFD3525, 0x77A1E680, 0x6AA4D638, 0xA1F8059D, 0x276C7733, 0xEC30A496, 0x191C11EE,
+            0xD240C24B, 0x54D4B0E5, 0x9F886340, 0x828D53F8, 0x49D1805D, 0xCF45F2F3, 0x04192156,
+            0xF54F9383, 0x3E134026, 0xB8873288, 0x73DBE12D, 0x6EDED195, 0xA5820230, 0x2316709E,
+            0xE84AA33B, 0x1ACA1375, 0xD196C0D0, 0x5702B27E, 0x9C5E61DB, 0x815B5163, 0x4A0782C6,
+            0xCC93F068, 0x07CF23CD, 0xF6999118, 0x3DC542BD, 0xBB513013, 0x700DE3B6, 0x6D08D30E,
+            0xA65400AB, 0x20C07205, 0xEB9CA1A0, 0x11E81EB4, 0xDAB4CD11, 0x5C20BFBF, 0x977C6C1A,
+            0x8A795CA2, 0x41258F07, 0xC7B1FDA9, 0x0CED2E0C, 0xFDBB9CD9, 0x36E74F7C, 0xB0733DD2,
+            0x7B2FEE77, 0x662ADECF, 0xAD760D6A, 0x2BE27FC4, 0xE0BEAC61, 0x123E1C2F, 0xD962CF8A,
+            0x5FF6BD24, 0x94AA6E81, 0x89AF5E39, 0x42F38D9C, 0xC467FF32, 0x0F3B2C97, 0xFE6D9E42,
+            0x35314DE7, 0xB3A53F49, 0x78F9ECEC, 0x65FCDC54, 0xAEA00FF1, 0x28347D5F, 0xE368AEFA,
+            0x16441B82, 0xDD18C827, 0x5B8CBA89, 0x90D0692C, 0x8DD55994, 0x46898A31, 0xC01DF89F,
+            0x0B412B3A, 0xFA1799EF, 0x314B4A4A, 0xB7DF38E4, 0x7C83EB41, 0x6186DBF9, 0xAADA085C,
+            0x2C4E7AF2, 0xE712A957, 0x15921919, 0xDECECABC, 0x585AB812, 0x93066BB7, 0x8E035B0F,
+            0x455F88AA, 0xC3CBFA04, 0x089729A1, 0xF9C19B74, 0x329D48D1, 0xB4093A7F, 0x7F55E9DA,
+            0x6250D962, 0xA90C0AC7, 0x2F987869, 0xE4C4ABCC
+          },
+          {
+            0x00000000, 0xA6770BB4, 0x979F1129, 0x31E81A9D, 0xF44F2413, 0x52382FA7, 0x63D0353A,
+            0xC5A73E8E, 0x33EF4E67, 0x959845D3, 0xA4705F4E, 0x020754FA, 0xC7A06A74, 0x61D761C0,
+            0x503F7B5D, 0xF64870E9, 0x67DE9CCE, 0xC1A9977A, 0xF0418DE7, 0x56368653, 0x9391B8DD,
+            0x35E6B369, 0x040EA9F4, 0xA279A240, 0x5431D2A9, 0xF246D91D, 0xC3AEC380, 0x65D9C834,
+            0xA07EF6BA, 0x0609FD0E, 0x37E1E793, 0x9196EC27, 0xCFBD399C, 0x69CA3228, 0x582228B5,
+            0xFE552301, 0x3BF21D8F, 0x9D85163B, 0xAC6D0CA6, 0x0A1A0712, 0xFC5277FB, 0x5A257C4F,
+            0x6BCD66D2, 0xCDBA6D66, 0x081D53E8, 0xAE6A585C, 0x9F8242C1, 0x39F54975, 0xA863A552,
+            0x0E14AEE6, 0x3FFCB47B, 0x998BBFCF, 0x5C2C8141, 0xFA5B8AF5, 0xCBB39068, 0x6DC49BDC,
+            0x9B8CEB35, 0x3DFBE081, 0x0C13FA1C, 0xAA64F1A8, 0x6FC3CF26, 0xC9B4C492, 0xF85CDE0F,
+            0x5E2BD5BB, 0x440B7579, 0xE27C7ECD, 0xD3946450, 0x75E36FE4, 0xB044516A, 0x16335ADE,
+            0x27DB4043, 0x81AC4BF7, 0x77E43B1E, 0xD19330AA, 0xE07B2A37, 0x460C2183, 0x83AB1F0D,
+            0x25DC14B9, 0x14340E24, 0xB2430590, 0x23D5E9B7, 0x85A2E203, 0xB44AF89E, 0x123DF32A,
+            0xD79ACDA4, 0x71EDC610, 0x4005DC8D, 0xE672D739, 0x103AA7D0, 0xB64DAC64, 0x87A5B6F9,
+            0x21D2BD4D, 0xE47583C3, 0x42028877, 0x73EA92EA, 0xD59D995E, 0x8BB64CE5, 0x2DC14751,
+            0x1C295DCC, 0xBA5E5678, 0x7FF968F6, 0xD98E6342, 0xE86679DF, 0x4E11726B, 0xB8590282,
+            0x1E2E0936, 0x2FC613AB, 0x89B1181F, 0x4C162691, 0xEA612D25, 0xDB8937B8, 0x7DFE3C0C,
+            0xEC68D02B, 0x4A1FDB9F, 0x7BF7C102, 0xDD80CAB6, 0x1827F438, 0xBE50FF8C, 0x8FB8E511,
+            0x29CFEEA5, 0xDF879E4C, 0x79F095F8, 0x48188F65, 0xEE6F84D1, 0x2BC8BA5F, 0x8DBFB1EB,
+            0xBC57AB76, 0x1A20A0C2, 0x8816EAF2, 0x2E61E146, 0x1F89FBDB, 0xB9FEF06F, 0x7C59CEE1,
+            0xDA2EC555, 0xEBC6DFC8, 0x4DB1D47C, 0xBBF9A495, 0x1D8EAF21, 0x2C66B5BC, 0x8A11BE08,
+            0x4FB68086, 0xE9C18B32, 0xD82991AF, 0x7E5E9A1B, 0xEFC8763C, 0x49BF7D88, 0x78576715,
+            0xDE206CA1, 0x1B87522F, 0xBDF0599B, 0x8C184306, 0x2A6F48B2, 0xDC27385B, 0x7A5033EF,
+            0x4BB82972, 0xEDCF22C6, 0x28681C48, 0x8E1F17FC, 0xBFF70D61, 0x198006D5, 0x47ABD36E,
+            0xE1DCD8DA, 0xD034C247, 0x7643C9F3, 0xB3E4F77D, 0x1593FCC9, 0x247BE654, 0x820CEDE0,
+            0x74449D09, 0xD23396BD, 0xE3DB8C20, 0x45AC8794, 0x800BB91A, 0x267CB2AE, 0x1794A833,
+            0xB1E3A387, 0x20754FA0, 0x86024414, 0xB7EA5E89, 0x119D553D, 0xD43A6BB3, 0x724D6007,
+            0x43A57A9A, 0xE5D2712E, 0x139A01C7, 0xB5ED0A73, 0x840510EE, 0x22721B5A, 0xE7D525D4,
+            0x41A22E60, 0x704A34FD, 0xD63D3F49, 0xCC1D9F8B, 0x6A6A943F, 0x5B828EA2, 0xFDF58516,
+            0x3852BB98, 0x9E25B02C, 0xAFCDAAB1, 0x09BAA105, 0xFFF2D1EC, 0x5985DA58, 0x686DC0C5,
+            0xCE1ACB71, 0x0BBDF5FF, 0xADCAFE4B, 0x9C22E4D6, 0x3A55EF62, 0xABC30345, 0x0DB408F1,
+            0x3C5C126C, 0x9A2B19D8, 0x5F8C2756, 0xF9FB2CE2, 0xC813367F, 0x6E643DCB, 0x982C4D22,
+            0x3E5B4696, 0x0FB35C0B, 0xA9C457BF, 0x6C636931, 0xCA146285, 0xFBFC7818, 0x5D8B73AC,
+            0x03A0A617, 0xA5D7ADA3, 0x943FB73E, 0x3248BC8A, 0xF7EF8204, 0x519889B0, 0x6070932D,
+            0xC6079899, 0x304FE870, 0x9638E3C4, 0xA7D0F959, 0x01A7F2ED, 0xC400CC63, 0x6277C7D7,
+            0x539FDD4A, 0xF5E8D6FE, 0x647E3AD9, 0xC209316D, 0xF3E12BF0, 0x55962044, 0x90311ECA,
+            0x3646157E, 0x07AE0FE3, 0xA1D90457, 0x579174BE, 0xF1E67F0A, 0xC00E6597, 0x66796E23,
+            0xA3DE50AD, 0x05A95B19, 0x34414184, 0x92364A30
+          },
+          {
+            0x00000000, 0xCCAA009E, 0x4225077D, 0x8E8F07E3, 0x844A0EFA, 0x48E00E64, 0xC66F0987,
+            0x0AC50919, 0xD3E51BB5, 0x1F4F1B2B, 0x91C01CC8, 0x5D6A1C56, 0x57AF154F, 0x9B0515D1,
+            0x158A1232, 0xD92012AC, 0x7CBB312B, 0xB01131B5, 0x3E9E3656, 0xF23436C8, 0xF8F13FD1,
+            0x345B3F4F, 0xBAD438AC, 0x767E3832, 0xAF5E2A9E, 0x63F42A00, 0xED7B2DE3, 0x21D12D7D,
+            0x2B142464, 0xE7BE24FA, 0x69312319, 0xA59B2387, 0xF9766256, 0x35DC62C8, 0xBB53652B,
+            0x77F965B5, 0x7D3C6CAC, 0xB1966C32, 0x3F196BD1, 0xF3B36B4F, 0x2A9379E3, 0xE639797D,
+            0x68B67E9E, 0xA41C7E00, 0xAED97719, 0x62737787, 0xECFC7064, 0x205670FA, 0x85CD537D,
+            0x496753E3, 0xC7E85400, 0x0B42549E, 0x01875D87, 0xCD2D5D19, 0x43A25AFA, 0x8F085A64,
+            0x562848C8, 0x9A824856, 0x140D4FB5, 0xD8A74F2B, 0xD2624632, 0x1EC846AC, 0x9047414F,
+            0x5CED41D1, 0x299DC2ED, 0xE537C273, 0x6BB8C590, 0xA712C50E, 0xADD7CC17, 0x617DCC89,
+            0xEFF2CB6A, 0x2358CBF4, 0xFA78D958, 0x36D2D9C6, 0xB85DDE25, 0x74F7DEBB, 0x7E32D7A2,
+            0xB298D73C, 0x3C17D0DF, 0xF0BDD041, 0x5526F3C6, 0x998CF358, 0x1703F4BB, 0xDBA9F425,
+            0xD16CFD3C, 0x1DC6FDA2, 0x9349FA41, 0x5FE3FADF, 0x86C3E873, 0x4A69E8ED, 0xC4E6EF0E,
+            0x084CEF90, 0x0289E689, 0xCE23E617, 0x40ACE1F4, 0x8C06E16A, 0xD0EBA0BB, 0x1C41A025,
+            0x92CEA7C6, 0x5E64A758, 0x54A1AE41, 0x980BAEDF, 0x1684A93C, 0xDA2EA9A2, 0x030EBB0E,
+            0xCFA4BB90, 0x412BBC73, 0x8D81BCED, 0x8744B5F4, 0x4BEEB56A, 0xC561B289, 0x09CBB217,
+            0xAC509190, 0x60FA910E, 0xEE7596ED, 0x22DF9673, 0x281A9F6A, 0xE4B09FF4, 0x6A3F9817,
+            0xA6959889, 0x7FB58A25, 0xB31F8ABB, 0x3D908D58, 0xF13A8DC6, 0xFBFF84DF, 0x37558441,
+            0xB9DA83A2, 0x7570833C, 0x533B85DA, 0x9F918544, 0x111E82A7, 0xDDB48239, 0xD7718B20,
+            0x1BDB8BBE, 0x95548C5D, 0x59FE8CC3, 0x80DE9E6F, 0x4C749EF1, 0xC2FB9912, 0x0E51998C,
+            0x04949095, 0xC83E900B, 0x46B197E8, 0x8A1B9776, 0x2F80B4F1, 0xE32AB46F, 0x6DA5B38C,
+            0xA10FB312, 0xABCABA0B, 0x6760BA95, 0xE9EFBD76, 0x2545BDE8, 0xFC65AF44, 0x30CFAFDA,
+            0xBE40A839, 0x72EAA8A7, 0x782FA1BE, 0xB485A120, 0x3A0AA6C3, 0xF6A0A65D, 0xAA4DE78C,
+            0x66E7E712, 0xE868E0F1, 0x24C2E06F, 0x2E07E976, 0xE2ADE9E8, 0x6C22EE0B, 0xA088EE95,
+            0x79A8FC39, 0xB502FCA7, 0x3B8DFB44, 0xF727FBDA, 0xFDE2F2C3, 0x3148F25D, 0xBFC7F5BE,
+            0x736DF520, 0xD6F6D6A7, 0x1A5CD639, 0x94D3D1DA, 0x5879D144, 0x52BCD85D, 0x9E16D8C3,
+            0x1099DF20, 0xDC33DFBE, 0x0513CD12, 0xC9B9CD8C, 0x4736CA6F, 0x8B9CCAF1, 0x8159C3E8,
+            0x4DF3C376, 0xC37CC495, 0x0FD6C40B, 0x7AA64737, 0xB60C47A9, 0x3883404A, 0xF42940D4,
+            0xFEEC49CD, 0x32464953, 0xBCC94EB0, 0x70634E2E, 0xA9435C82, 0x65E95C1C, 0xEB665BFF,
+            0x27CC5B61, 0x2D095278, 0xE1A352E6, 0x6F2C5505, 0xA386559B, 0x061D761C, 0xCAB77682,
+            0x44387161, 0x889271FF, 0x825778E6, 0x4EFD7878, 0xC0727F9B, 0x0CD87F05, 0xD5F86DA9,
+            0x19526D37, 0x97DD6AD4, 0x5B776A4A, 0x51B26353, 0x9D1863CD, 0x1397642E, 0xDF3D64B0,
+            0x83D02561, 0x4F7A25FF, 0xC1F5221C, 0x0D5F2282, 0x079A2B9B, 0xCB302B05, 0x45BF2CE6,
+            0x89152C78, 0x50353ED4, 0x9C9F3E4A, 0x121039A9, 0xDEBA3937, 0xD47F302E, 0x18D530B0,
+            0x965A3753, 0x5AF037CD, 0xFF6B144A, 0x33C114D4, 0xBD4E1337, 0x71E413A9, 0x7B211AB0,
+            0xB78B1A2E, 0x39041DCD, 0xF5AE1D53, 0x2C8E0FFF, 0xE0240F61, 0x6EAB0882, 0xA201081C,
+            0xA8C40105, 0x646E019B, 0xEAE10678, 0x264B06E6
+          }
         };
 
-    mz_uint32 crc32 = (mz_uint32)crc ^ 0xFFFFFFFF;
-    const mz_uint8 *pByte_buf = (const mz_uint8 *)ptr;
-
-    while (buf_len >= 4)
+    while (buf_len >= 8)
     {
-        crc32 = (crc32 >> 8) ^ s_crc_table[(crc32 ^ pByte_buf[0]) & 0xFF];
-        crc32 = (crc32 >> 8) ^ s_crc_table[(crc32 ^ pByte_buf[1]) & 0xFF];
-        crc32 = (crc32 >> 8) ^ s_crc_table[(crc32 ^ pByte_buf[2]) & 0xFF];
-        crc32 = (crc32 >> 8) ^ s_crc_table[(crc32 ^ pByte_buf[3]) & 0xFF];
-        pByte_buf += 4;
-        buf_len -= 4;
+        mz_uint32 low = MZ_READ_LE32(pByte_buf) ^ crc32;
+        mz_uint32 high = MZ_READ_LE32(pByte_buf + 4);
+        crc32 = s_crc_table[7][low & 0xFF] ^ s_crc_table[6][(low >> 8) & 0xFF] ^
+                s_crc_table[5][(low >> 16) & 0xFF] ^ s_crc_table[4][low >> 24] ^
+                s_crc_table[3][high & 0xFF] ^ s_crc_table[2][(high >> 8) & 0xFF] ^
+                s_crc_table[1][(high >> 16) & 0xFF] ^ s_crc_table[0][high >> 24];
+        pByte_buf += 8;
+        buf_len -= 8;
     }
 
     while (buf_len)
     {
-        crc32 = (crc32 >> 8) ^ s_crc_table[(crc32 ^ pByte_buf[0]) & 0xFF];
+        crc32 = (crc32 >> 8) ^ s_crc_table[0][(crc32 ^ pByte_buf[0]) & 0xFF];
         ++pByte_buf;
         --buf_len;
     }
 
-    return ~crc32;
+    return crc32;
+}
+
+#if defined(MINIZ_X86_SIMD)
+/* Folds 64 bytes at a time with carry-less multiplies, then Barrett reduces to 32 bits (Intel's "Fast CRC Computation Using PCLMULQDQ" white paper). */
+/* buf_len must be at least 64 and a multiple of 16, the CRC is neither pre nor post inverted. */
+static MINIZ_PCLMUL_TARGET mz_uint32 mz_crc32_pclmul(mz_uint32 crc32, const mz_uint8 *pByte_buf, size_t buf_len)
+{
+    static const mz_uint64 s_k1k2[2] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+    static const mz_uint64 s_k3k4[2] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+    static const mz_uint64 s_k5k0[2] = { 0x0163cd6124ULL, 0x0000000000ULL };
+    static const mz_uint64 s_poly[2] = { 0x01db710641ULL, 0x01f7011641ULL };
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(pByte_buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(pByte_buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(pByte_buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(pByte_buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc32));
+    x0 = _mm_loadu_si128((const __m128i *)s_k1k2);
+    pByte_buf += 64;
+    buf_len -= 64;
+
+    /* Fold four lanes in parallel */
+    while (buf_len >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(pByte_buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(pByte_buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(pByte_buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(pByte_buf + 0x30)));
+        pByte_buf += 64;
+        buf_len -= 64;
+    }
+
+    /* Fold the lanes into one */
+    x0 = _mm_loadu_si128((const __m128i *)s_k3k4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (buf_len >= 16)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)pByte_buf)), x5);
+        pByte_buf += 16;
+        buf_len -= 16;
+    }
+
+    /* 128 to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64((const __m128i *)s_k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_loadu_si128((const __m128i *)s_poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (mz_uint32)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif /* MINIZ_X86_SIMD */
+
+#if defined(MINIZ_CRC32_ARMV8)
+/* Uses the ARMv8 CRC32 instructions, the CRC is neither pre nor post inverted. */
+static mz_uint32 mz_crc32_armv8(mz_uint32 crc32, const mz_uint8 *pByte_buf, size_t buf_len)
+{
+    while (buf_len && ((size_t)pByte_buf & 7))
+    {
+        crc32 = __crc32b(crc32, *pByte_buf++);
+        --buf_len;
+    }
+    while (buf_len >= 32)
+    {
+        const mz_uint64 *pWords = (const mz_uint64 *)pByte_buf;
+        crc32 = __crc32d(crc32, pWords[0]);
+        crc32 = __crc32d(crc32, pWords[1]);
+        crc32 = __crc32d(crc32, pWords[2]);
+        crc32 = __crc32d(crc32, pWords[3]);
+        pByte_buf += 32;
+        buf_len -= 32;
+    }
+    while (buf_len >= 8)
+    {
+        crc32 = __crc32d(crc32, *(const mz_uint64 *)pByte_buf);
+        pByte_buf += 8;
+        buf_len -= 8;
+    }
+    while (buf_len--)
+        crc32 = __crc32b(crc32, *pByte_buf++);
+    return crc32;
+}
+#endif /* MINIZ_CRC32_ARMV8 */
+
+/* Picks the fastest implementation the CPU supports, PCLMULQDQ is detected at runtime (on the first call). */
+mz_ulong mz_crc32(mz_ulong crc, const mz_uint8 *ptr, size_t buf_len)
+{
+    mz_uint32 crc32 = (mz_uint32)crc ^ 0xFFFFFFFF;
+
+#if defined(MINIZ_CRC32_ARMV8)
+    return ~mz_crc32_armv8(crc32, ptr, buf_len);
+#else
+#if defined(MINIZ_X86_SIMD)
+    static const mz_uint s_cpu_features = mz_x86_cpu_features();
+    if (buf_len >= 64 && (s_cpu_features & MZ_X86_PCLMUL))
+    {
+        size_t folded_len = buf_len & ~(size_t)15;
+        crc32 = mz_crc32_pclmul(crc32, ptr, folded_len);
+        ptr += folded_len;
+        buf_len -= folded_len;
+    }
+#endif
+    return ~mz_crc32_slice_by_8(crc32, ptr, buf_len);
+#endif
 }
 #endif
 
+static mz_uint32 mz_gf2_matrix_times(const mz_uint32 *pMat, mz_uint32 vec)
+{
+    mz_uint32 sum = 0;
+    for (; vec; vec >>= 1, pMat++)
+    {
+        if (vec & 1)
+            sum ^= *pMat;
+    }
+    return sum;
+}
+
+static void mz_gf2_matrix_square(mz_uint32 *pSquare, const mz_uint32 *pMat)
+{
+    int n;
+    for (n = 0; n < 32; n++)
+        pSquare[n] = mz_gf2_matrix_times(pMat, pMat[n]);
+}
+
+mz_ulong mz_crc32_combine(mz_ulong crc1, mz_ulong crc2, size_t len2)
+{
+    int n;
+    mz_uint32 row, even[32], odd[32];
+    mz_uint32 crc = (mz_uint32)crc1;
+
+    if (!len2)
+        return crc1;
+
+    /* Operator for one zero bit */
+    odd[0] = 0xEDB88320;
+    for (n = 1, row = 1; n < 32; n++, row <<= 1)
+        odd[n] = row;
+
+    /* Operators for two and four zero bits */
+    mz_gf2_matrix_square(even, odd);
+    mz_gf2_matrix_square(odd, even);
+
+    /* Apply len2 zero bytes to crc1, squaring the operator for each bit of len2 (the first square gives the one zero byte operator) */
+    for (;;)
+    {
+        mz_gf2_matrix_square(even, odd);
+        if (len2 & 1)
+            crc = mz_gf2_matrix_times(even, crc);
+        if (!(len2 >>= 1))
+            break;
+
+        mz_gf2_matrix_square(odd, even);
+        if (len2 & 1)
+            crc = mz_gf2_matrix_times(odd, crc);
+        if (!(len2 >>= 1))
+            break;
+    }
+
+    return crc ^ (mz_uint32)crc2;
+}
+
 void mz_free(void *p)
 {
     MZ_FREE(p);
@@ -1382,11 +2037,58 @@ static mz_uint16 TDEFL_READ_UNALIGNED_WORD2(const mz_uint16* p)
 #define TDEFL_READ_UNALIGNED_WORD(p) *(const mz_uint16 *)(p)
 #define TDEFL_READ_UNALIGNED_WORD2(p) *(const mz_uint16 *)(p)
 #endif
+
+/* Match lengths are measured 8 bytes at a time, the first differing byte is found from the trailing zeros of the XOR (define TDEFL_NO_WIDE_MATCH to compare 2 bytes at a time instead). */
+#if !defined(TDEFL_NO_WIDE_MATCH) && MINIZ_LITTLE_ENDIAN && MINIZ_HAS_64BIT_REGISTERS && \
+    (defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))))
+#define TDEFL_WIDE_MATCH 1
+#if defined(_MSC_VER) && !defined(__clang__)
+static MZ_FORCEINLINE mz_uint tdefl_count_trailing_zeros64(mz_uint64 x)
+{
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (mz_uint)index;
+}
+#else
+#define tdefl_count_trailing_zeros64(x) ((mz_uint)__builtin_ctzll(x))
+#endif
+#ifdef MINIZ_UNALIGNED_USE_MEMCPY
+static mz_uint64 TDEFL_READ_UNALIGNED_WORD64(const mz_uint8* p)
+{
+    mz_uint64 ret;
+    memcpy(&ret, p, sizeof(mz_uint64));
+    return ret;
+}
+#else
+#define TDEFL_READ_UNALIGNED_WORD64(p) *(const mz_uint64 *)(p)
+#endif
+
+/* Returns the length of the common prefix of p and q, up to TDEFL_MAX_MATCH_LEN bytes (which both must have). */
+static MZ_FORCEINLINE mz_uint tdefl_match_len(const mz_uint8 *p, const mz_uint8 *q)
+{
+    mz_uint len;
+    for (len = 0; len + 8 <= TDEFL_MAX_MATCH_LEN; len += 8)
+    {
+        mz_uint64 diff = TDEFL_READ_UNALIGNED_WORD64(p + len) ^ TDEFL_READ_UNALIGNED_WORD64(q + len);
+        if (diff)
+            return len + (tdefl_count_trailing_zeros64(diff) >> 3);
+    }
+    while ((len < TDEFL_MAX_MATCH_LEN) && (p[len] == q[len]))
+        len++;
+    return len;
+}
+#else
+#define TDEFL_WIDE_MATCH 0
+#endif
+
 static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahead_pos, mz_uint max_dist, mz_uint max_match_len, mz_uint *pMatch_dist, mz_uint *pMatch_len)
 {
     mz_uint dist, pos = lookahead_pos & TDEFL_LZ_DICT_SIZE_MASK, match_len = *pMatch_len, probe_pos = pos, next_probe_pos, probe_len;
     mz_uint num_probes_left = d->m_max_probes[match_len >= 32];
-    const mz_uint16 *s = (const mz_uint16 *)(d->m_dict + pos), *p, *q;
+    const mz_uint16 *s = (const mz_uint16 *)(d->m_dict + pos), *q;
+#if !TDEFL_WIDE_MATCH
+    const mz_uint16 *p;
+#endif
     mz_uint16 c01 = TDEFL_READ_UNALIGNED_WORD(&d->m_dict[pos + match_len - 1]), s01 = TDEFL_READ_UNALIGNED_WORD2(s);
     MZ_ASSERT(max_match_len <= TDEFL_MAX_MATCH_LEN);
     if (max_match_len <= match_len)
@@ -1413,6 +2115,10 @@ static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahe
         q = (const mz_uint16 *)(d->m_dict + probe_pos);
         if (TDEFL_READ_UNALIGNED_WORD2(q) != s01)
             continue;
+#if TDEFL_WIDE_MATCH
+        probe_len = tdefl_match_len((const mz_uint8 *)s, (const mz_uint8 *)q);
+        if (probe_len == TDEFL_MAX_MATCH_LEN)
+#else
         p = s;
         probe_len = 32;
         do
@@ -1420,12 +2126,17 @@ static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahe
         } while ((TDEFL_READ_UNALIGNED_WORD2(++p) == TDEFL_READ_UNALIGNED_WORD2(++q)) && (TDEFL_READ_UNALIGNED_WORD2(++p) == TDEFL_READ_UNALIGNED_WORD2(++q)) &&
                  (TDEFL_READ_UNALIGNED_WORD2(++p) == TDEFL_READ_UNALIGNED_WORD2(++q)) && (TDEFL_READ_UNALIGNED_WORD2(++p) == TDEFL_READ_UNALIGNED_WORD2(++q)) && (--probe_len > 0));
         if (!probe_len)
+#endif
         {
             *pMatch_dist = dist;
             *pMatch_len = MZ_MIN(max_match_len, (mz_uint)TDEFL_MAX_MATCH_LEN);
             break;
         }
+#if TDEFL_WIDE_MATCH
+        else if (probe_len > match_len)
+#else
         else if ((probe_len = ((mz_uint)(p - s) * 2) + (mz_uint)(*(const mz_uint8 *)p == *(const mz_uint8 *)q)) > match_len)
+#endif
         {
             *pMatch_dist = dist;
             if ((*pMatch_len = match_len = MZ_MIN(max_match_len, probe_len)) == max_match_len)
@@ -1491,6 +2202,13 @@ static mz_uint32 TDEFL_READ_UNALIGNED_WORD32(const mz_uint8* p)
 #else
 #define TDEFL_READ_UNALIGNED_WORD32(p) *(const mz_uint32 *)(p)
 #endif
+
+/* Hash of the trigram at the current position used by tdefl_compress_fast() (and tdefl_set_dictionary() to prime it), multiplicative unless TDEFL_LEVEL1_XOR_HASH is defined. */
+#ifdef TDEFL_LEVEL1_XOR_HASH
+#define TDEFL_LEVEL1_HASH(trigram) (((trigram) ^ ((trigram) >> (24 - (TDEFL_LZ_HASH_BITS - 8)))) & TDEFL_LEVEL1_HASH_SIZE_MASK)
+#else
+#define TDEFL_LEVEL1_HASH(trigram) ((mz_uint)(((mz_uint32)(trigram) * 2654435761U) >> 20) & TDEFL_LEVEL1_HASH_SIZE_MASK)
+#endif
 static mz_bool tdefl_compress_fast(tdefl_compressor *d)
 {
     /* Faster, minimally featured LZRW1-style match+parse loop with better register utilization. Intended for applications where raw throughput is valued more highly than ratio. */
@@ -1526,12 +2244,17 @@ static mz_bool tdefl_compress_fast(tdefl_compressor *d)
             mz_uint cur_match_dist, cur_match_len = 1;
             mz_uint8 *pCur_dict = d->m_dict + cur_pos;
             mz_uint first_trigram = TDEFL_READ_UNALIGNED_WORD32(pCur_dict) & 0xFFFFFF;
-            mz_uint hash = (first_trigram ^ (first_trigram >> (24 - (TDEFL_LZ_HASH_BITS - 8)))) & TDEFL_LEVEL1_HASH_SIZE_MASK;
+            mz_uint hash = TDEFL_LEVEL1_HASH(first_trigram);
             mz_uint probe_pos = d->m_hash[hash];
             d->m_hash[hash] = (mz_uint16)lookahead_pos;
 
             if (((cur_match_dist = (mz_uint16)(lookahead_pos - probe_pos)) <= dict_size) && ((TDEFL_READ_UNALIGNED_WORD32(d->m_dict + (probe_pos &= TDEFL_LZ_DICT_SIZE_MASK)) & 0xFFFFFF) == first_trigram))
             {
+#if TDEFL_WIDE_MATCH
+                cur_match_len = tdefl_match_len(pCur_dict, d->m_dict + probe_pos);
+                if ((cur_match_len == TDEFL_MAX_MATCH_LEN) && (!cur_match_dist))
+                    cur_match_len = 0;
+#else
                 const mz_uint16 *p = (const mz_uint16 *)pCur_dict;
                 const mz_uint16 *q = (const mz_uint16 *)(d->m_dict + probe_pos);
                 mz_uint32 probe_len = 32;
@@ -1542,6 +2265,7 @@ static mz_bool tdefl_compress_fast(tdefl_compressor *d)
                 cur_match_len = ((mz_uint)(p - (const mz_uint16 *)pCur_dict) * 2) + (mz_uint)(*(const mz_uint8 *)p == *(const mz_uint8 *)q);
                 if (!probe_len)
                     cur_match_len = cur_match_dist ? TDEFL_MAX_MATCH_LEN : 0;
+#endif
 
                 if ((cur_match_len < TDEFL_MIN_MATCH_LEN) || ((cur_match_len == TDEFL_MIN_MATCH_LEN) && (cur_match_dist >= 8U * 1024U)))
                 {
@@ -1983,6 +2707,47 @@ tdefl_status tdefl_init(tdefl_compressor *d, tdefl_put_buf_func_ptr pPut_buf_fun
     return TDEFL_STATUS_OKAY;
 }
 
+tdefl_status tdefl_set_dictionary(tdefl_compressor *d, const void *pDict, size_t dict_size)
+{
+    const mz_uint8 *pSrc = (const mz_uint8 *)pDict;
+    mz_uint i, n;
+
+    if ((d->m_lookahead_pos) || (d->m_lookahead_size) || (d->m_total_lz_bytes) || ((dict_size) && (!pDict)))
+        return (d->m_prev_return_status = TDEFL_STATUS_BAD_PARAM);
+
+    n = (mz_uint)MZ_MIN(dict_size, (size_t)TDEFL_LZ_DICT_SIZE);
+    pSrc += dict_size - n;
+    memcpy(d->m_dict, pSrc, n);
+    memcpy(d->m_dict + TDEFL_LZ_DICT_SIZE, pSrc, MZ_MIN(n, (mz_uint)(TDEFL_MAX_MATCH_LEN - 1)));
+
+    /* Insert every trigram that lies entirely within the dictionary, the same way the match finder in use would have */
+#if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
+    if (((d->m_flags & TDEFL_MAX_PROBES_MASK) == 1) &&
+        ((d->m_flags & TDEFL_GREEDY_PARSING_FLAG) != 0) &&
+        ((d->m_flags & (TDEFL_FILTER_MATCHES | TDEFL_FORCE_ALL_RAW_BLOCKS | TDEFL_RLE_MATCHES)) == 0))
+    {
+        for (i = 0; i + 2 < n; i++)
+        {
+            mz_uint first_trigram = pSrc[i] | (pSrc[i + 1] << 8) | (pSrc[i + 2] << 16);
+            mz_uint hash = TDEFL_LEVEL1_HASH(first_trigram);
+            d->m_hash[hash] = (mz_uint16)i;
+        }
+    }
+    else
+#endif /* #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN */
+    {
+        for (i = 0; i + 2 < n; i++)
+        {
+            mz_uint hash = ((pSrc[i] << (TDEFL_LZ_HASH_SHIFT * 2)) ^ (pSrc[i + 1] << TDEFL_LZ_HASH_SHIFT) ^ pSrc[i + 2]) & (TDEFL_LZ_HASH_SIZE - 1);
+            d->m_next[i] = d->m_hash[hash];
+            d->m_hash[hash] = (mz_uint16)i;
+        }
+    }
+
+    d->m_lookahead_pos = d->m_dict_size = d->m_lz_code_buf_dict_pos = n;
+    return TDEFL_STATUS_OKAY;
+}
+
 tdefl_status tdefl_get_prev_return_status(tdefl_compressor *d)
 {
     return d->m_prev_return_status;
@@ -2242,6 +3007,26 @@ extern "C" {
 #define TINFL_MEMCPY(d, s, l) memcpy(d, s, l)
 #define TINFL_MEMSET(p, c, l) memset(p, c, l)
 
+/* The fast loop keeps the 64-bit bit buffer topped up with 8 byte loads and copies matches 8 bytes at a time (see tinfl_decompress()). */
+#if TINFL_USE_64BIT_BITBUF && MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
+#define TINFL_FAST_LOOP 1
+#ifdef MINIZ_UNALIGNED_USE_MEMCPY
+static mz_uint64 TINFL_READ_LE64(const mz_uint8 *p)
+{
+    mz_uint64 ret;
+    memcpy(&ret, p, sizeof(mz_uint64));
+    return ret;
+}
+#else
+#define TINFL_READ_LE64(p) *(const mz_uint64 *)(p)
+#endif
+#else
+#define TINFL_FAST_LOOP 0
+#endif
+
+/* Coroutine state at the start of each deflate block but the first, see tinfl_init_at_block_start() */
+#define TINFL_BLOCK_START_STATE 54
+
 #define TINFL_CR_BEGIN  \
     switch (r->m_state) \
     {                   \
@@ -2604,6 +3389,63 @@ tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_nex
                 mz_uint8 *pSrc;
                 for (;;)
                 {
+#if TINFL_FAST_LOOP
+                    /* Emits literals while 8 bytes of input can be loaded at once: the refill adds whole bytes only (leaving the bits past num_bits */
+                    /* to be ORed again with the same values), so there are always 56+ bits, enough for a literal/length, its extra bits and a distance */
+                    if (((pIn_buf_end - pIn_buf_cur) >= 8) && (pOut_buf_cur < pOut_buf_end))
+                    {
+                        int sym2;
+                        mz_uint code_len;
+                        do
+                        {
+                            bit_buf |= TINFL_READ_LE64(pIn_buf_cur) << num_bits;
+                            pIn_buf_cur += (63 - num_bits) >> 3;
+                            num_bits |= 56;
+                            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
+                                code_len = sym2 >> 9;
+                            else
+                            {
+                                code_len = TINFL_FAST_LOOKUP_BITS;
+                                do
+                                {
+                                    sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)];
+                                } while (sym2 < 0);
+                            }
+                            bit_buf >>= code_len;
+                            num_bits -= code_len;
+                            if (sym2 & 256)
+                                break;
+                            *pOut_buf_cur++ = (mz_uint8)sym2;
+                            if (pOut_buf_cur >= pOut_buf_end)
+                                break;
+
+                            /* A second symbol fits in what is left of the bit buffer */
+                            if ((sym2 = r->m_tables[0].m_look_up[bit_buf & (TINFL_FAST_LOOKUP_SIZE - 1)]) >= 0)
+                                code_len = sym2 >> 9;
+                            else
+                            {
+                                code_len = TINFL_FAST_LOOKUP_BITS;
+                                do
+                                {
+                                    sym2 = r->m_tables[0].m_tree[~sym2 + ((bit_buf >> code_len++) & 1)];
+                                } while (sym2 < 0);
+                            }
+                            bit_buf >>= code_len;
+                            num_bits -= code_len;
+                            if (sym2 & 256)
+                                break;
+                            *pOut_buf_cur++ = (mz_uint8)sym2;
+                        } while (((pIn_buf_end - pIn_buf_cur) >= 8) && (pOut_buf_cur < pOut_buf_end));
+                        /* The rest of the decoder expects zeros past num_bits */
+                        bit_buf &= (((tinfl_bit_buf_t)1) << num_bits) - 1;
+                        if (sym2 & 256)
+                        {
+                            counter = sym2;
+                            break;
+                        }
+                        continue;
+                    }
+#endif
                     if (((pIn_buf_end - pIn_buf_cur) < 4) || ((pOut_buf_end - pOut_buf_cur) < 2))
                     {
                         TINFL_HUFF_DECODE(23, counter, &r->m_tables[0]);
@@ -2724,6 +3566,43 @@ tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_nex
                     }
                     continue;
                 }
+#if TINFL_FAST_LOOP
+                /* Matches at least 8 bytes back are copied 8 bytes at a time, the last chunk overlapping the previous one rather than */
+                /* running past the end of the match, so nothing is written beyond it. Shorter matches use two overlapping 4 byte copies. */
+                else if ((dist >= 8) && (pSrc < pOut_buf_cur))
+                {
+                    mz_uint8 *pOut_match_end = pOut_buf_cur + counter;
+                    const mz_uint8 *pSrc_end = pSrc + counter;
+                    if (counter >= 8)
+                    {
+                        do
+                        {
+                            memcpy(pOut_buf_cur, pSrc, sizeof(mz_uint64));
+                            pOut_buf_cur += 8;
+                            pSrc += 8;
+                        } while (pOut_buf_cur + 8 < pOut_match_end);
+                        memcpy(pOut_match_end - 8, pSrc_end - 8, sizeof(mz_uint64));
+                    }
+                    else if (counter >= 4)
+                    {
+                        memcpy(pOut_buf_cur, pSrc, sizeof(mz_uint32));
+                        memcpy(pOut_match_end - 4, pSrc_end - 4, sizeof(mz_uint32));
+                    }
+                    else
+                    {
+                        while (pOut_buf_cur < pOut_match_end)
+                            *pOut_buf_cur++ = *pSrc++;
+                    }
+                    pOut_buf_cur = pOut_match_end;
+                    continue;
+                }
+                else if (dist == 1)
+                {
+                    TINFL_MEMSET(pOut_buf_cur, pSrc[0], counter);
+                    pOut_buf_cur += counter;
+                    continue;
+                }
+#endif
 #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES
                 else if ((counter >= 9) && (counter <= dist))
                 {
@@ -2769,6 +3648,11 @@ tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_nex
                 }
             }
         }
+        if ((decomp_flags & TINFL_FLAG_STOP_AT_BLOCK_START) && !(r->m_final & 1))
+        {
+            /* tinfl_init_at_block_start() resumes here */
+            TINFL_CR_RETURN(TINFL_BLOCK_START_STATE, TINFL_STATUS_BLOCK_START);
+        }
     } while (!(r->m_final & 1));
 
     /* Ensure byte alignment and put back any bytes from the bitbuf if we've looked ahead too far on gzip, or other Deflate streams followed by arbitrary data. */
@@ -2850,6 +3734,18 @@ common_exit:
     return status;
 }
 
+void tinfl_init_at_block_start(tinfl_decompressor *r, mz_uint32 bit_buf, mz_uint num_bits)
+{
+    r->m_state = TINFL_BLOCK_START_STATE;
+    r->m_num_bits = num_bits & 7;
+    r->m_bit_buf = bit_buf & ((1U << r->m_num_bits) - 1U);
+    r->m_final = r->m_type = 0;
+    r->m_dist = r->m_counter = r->m_num_extra = 0;
+    r->m_zhdr0 = r->m_zhdr1 = 0;
+    r->m_z_adler32 = r->m_check_adler32 = 1;
+    r->m_dist_from_out_buf_start = 0;
+}
+
 /* Higher level helper functions. */
 void *tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags)
 {
@@ -3149,10 +4045,71 @@ static int mz_utime(const char *pFilename, struct utimbuf* const pTime)
 #define MZ_FREOPEN(f, m, s) freopen(f, m, s)
 #define MZ_DELETE_FILE remove
 #endif /* #ifdef _MSC_VER */
+
+/* Archives opened for reading are memory mapped where possible (define MINIZ_NO_MMAP to always use stdio). */
+#if !defined(MINIZ_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MINIZ_USE_MMAP 1
+#endif
+
+/* Archive files are read and written with positional I/O where possible (define MINIZ_NO_PREAD to always use stdio). */
+/* Unlike fseek+fread, it doesn't touch the shared file position, so multiple threads can read entries of the same archive at once. */
+#if !defined(MINIZ_NO_PREAD) && (defined(__unix__) || defined(__APPLE__))
+#include <errno.h>
+#include <unistd.h>
+#define MINIZ_USE_PREAD 1
+#endif
+
+/* Extracted files get their blocks allocated up front where possible, so big entries aren't written out in fragments (define MINIZ_NO_FALLOCATE to skip it). */
+/* The file size is left alone, so an extraction that fails partway leaves a short file rather than one with a zero filled tail. */
+#if !defined(MINIZ_NO_FALLOCATE) && defined(__linux__)
+#include <fcntl.h>
+#include <linux/falloc.h>
+#define MINIZ_USE_FALLOCATE 1
+#endif
+
+/* Stored entries are copied between the archive and their files by the kernel where possible, when extracting and when adding from stdio files (define MINIZ_NO_COPY_FILE_RANGE to always copy through user space). */
+#if !defined(MINIZ_NO_COPY_FILE_RANGE) && defined(MINIZ_USE_PREAD) && defined(__linux__)
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#define MINIZ_USE_COPY_FILE_RANGE 1
+#endif
+
+/* Define MINIZ_MMAP_EXTRACT to extract big entries by inflating straight into their memory mapped, preallocated destination file. */
+/* It's off by default: the page faults on the mapping cost more than the fwrite calls they replace on the file systems we measured (ext4). */
+#if defined(MINIZ_MMAP_EXTRACT) && defined(MINIZ_USE_MMAP) && defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#define MINIZ_USE_MMAP_EXTRACT 1
+#endif
+
 #endif /* #ifdef MINIZ_NO_STDIO */
 
 #define MZ_TOLOWER(c) ((((c) >= 'A') && ((c) <= 'Z')) ? ((c) - 'A' + 'a') : (c))
 
+static MZ_FORCEINLINE void mz_write_le16(mz_uint8 *p, mz_uint16 v)
+{
+    p[0] = (mz_uint8)v;
+    p[1] = (mz_uint8)(v >> 8);
+}
+static MZ_FORCEINLINE void mz_write_le32(mz_uint8 *p, mz_uint32 v)
+{
+    p[0] = (mz_uint8)v;
+    p[1] = (mz_uint8)(v >> 8);
+    p[2] = (mz_uint8)(v >> 16);
+    p[3] = (mz_uint8)(v >> 24);
+}
+static MZ_FORCEINLINE void mz_write_le64(mz_uint8 *p, mz_uint64 v)
+{
+    mz_write_le32(p, (mz_uint32)v);
+    mz_write_le32(p + sizeof(mz_uint32), (mz_uint32)(v >> 32));
+}
+
+#define MZ_WRITE_LE16(p, v) mz_write_le16((mz_uint8 *)(p), (mz_uint16)(v))
+#define MZ_WRITE_LE32(p, v) mz_write_le32((mz_uint8 *)(p), (mz_uint32)(v))
+#define MZ_WRITE_LE64(p, v) mz_write_le64((mz_uint8 *)(p), (mz_uint64)(v))
+
 /* Various ZIP archive enums. To completely avoid cross platform compiler alignment and platform endian issues, miniz.c doesn't use structs for any of this stuff. */
 enum
 {
@@ -3170,6 +4127,9 @@ enum
     MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE = 56,
     MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE = 20,
     MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID = 0x0001,
+    MZ_ZIP_DATA_ALIGNMENT_FIELD_HEADER_ID = 0xD935,
+    MZ_ZIP_DATA_ALIGNMENT_FIELD_MIN_SIZE = 6,
+    MZ_ZIP_MAX_DATA_ALIGNMENT = 0x8000,
     MZ_ZIP_DATA_DESCRIPTOR_ID = 0x08074b50,
     MZ_ZIP_DATA_DESCRIPTER_SIZE64 = 24,
     MZ_ZIP_DATA_DESCRIPTER_SIZE32 = 16,
@@ -3243,6 +4203,12 @@ enum
     MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_UTF8 = 1 << 11
 };
 
+/* Wrapping output buffer for extraction, the size of the dictionary. */
+#define MZ_ZIP_INFLATE_BUF_SIZE TINFL_LZ_DICT_SIZE
+
+/* stdio buffer for extracted files, so they're written in big chunks rather than one per callback. */
+#define MZ_ZIP_FILE_WRITE_BUF_SIZE (1024 * 1024)
+
 typedef struct
 {
     void *m_p;
@@ -3272,6 +4238,14 @@ struct mz_zip_internal_state_tag
     void *m_pMem;
     size_t m_mem_size;
     size_t m_mem_capacity;
+
+    /* The whole archive file when it's memory mapped (m_pMem then points into it, to the start of the archive). */
+    void *m_pMapping;
+    size_t m_mapping_size;
+
+    /* Allocated on first use by the writer and reused for every entry added, till the writer ends (a compressor is reset by tdefl_init()). */
+    tdefl_compressor *m_pCompressor;
+    void *m_pIO_buf;
 };
 
 #define MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(array_ptr, element_size) (array_ptr)->m_element_size = element_size
@@ -3851,6 +4825,45 @@ void mz_zip_zero_struct(mz_zip_archive *pZip)
         MZ_CLEAR_OBJ(*pZip);
 }
 
+#ifdef MINIZ_USE_MMAP
+static size_t mz_zip_mem_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n);
+
+/* Maps the archive file, so it's read through the memory paths: no seeks, and the compressed data is inflated right from the mapping. */
+/* Leaves the archive on stdio if the file can't be mapped. */
+static void mz_zip_file_map(mz_zip_archive *pZip)
+{
+    mz_zip_internal_state *pState = pZip->m_pState;
+    struct stat file_stat;
+    void *pMapping;
+
+    if ((fstat(fileno(pState->m_pFile), &file_stat) != 0) || (file_stat.st_size <= 0) || ((mz_uint64)file_stat.st_size > (mz_uint64)((size_t)-1)) ||
+        (pState->m_file_archive_start_ofs + pZip->m_archive_size > (mz_uint64)file_stat.st_size))
+        return;
+
+    pMapping = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_SHARED, fileno(pState->m_pFile), 0);
+    if (pMapping == MAP_FAILED)
+        return;
+
+    pState->m_pMapping = pMapping;
+    pState->m_mapping_size = (size_t)file_stat.st_size;
+    pState->m_pMem = (mz_uint8 *)pMapping + pState->m_file_archive_start_ofs;
+    pState->m_mem_size = (size_t)pZip->m_archive_size;
+    pZip->m_pRead = mz_zip_mem_read_func;
+}
+
+static void mz_zip_file_unmap(mz_zip_internal_state *pState)
+{
+    if (!pState->m_pMapping)
+        return;
+
+    munmap(pState->m_pMapping, pState->m_mapping_size);
+    pState->m_pMapping = NULL;
+    pState->m_mapping_size = 0;
+    pState->m_pMem = NULL;
+    pState->m_mem_size = 0;
+}
+#endif /* #ifdef MINIZ_USE_MMAP */
+
 static mz_bool mz_zip_reader_end_internal(mz_zip_archive *pZip, mz_bool set_last_error)
 {
     mz_bool status = MZ_TRUE;
@@ -3875,6 +4888,10 @@ static mz_bool mz_zip_reader_end_internal(mz_zip_archive *pZip, mz_bool set_last
         mz_zip_array_clear(pZip, &pState->m_central_dir_offsets);
         mz_zip_array_clear(pZip, &pState->m_sorted_central_dir_offsets);
 
+#ifdef MINIZ_USE_MMAP
+        mz_zip_file_unmap(pState);
+#endif
+
 #ifndef MINIZ_NO_STDIO
         if (pState->m_pFile)
         {
@@ -3968,7 +4985,28 @@ mz_bool mz_zip_reader_init_mem(mz_zip_archive *pZip, const void *pMem, size_t si
 static size_t mz_zip_file_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n)
 {
     mz_zip_archive *pZip = (mz_zip_archive *)pOpaque;
-    mz_int64 cur_ofs = MZ_FTELL64(pZip->m_pState->m_pFile);
+#ifdef MINIZ_USE_PREAD
+    size_t total = 0;
+    int fd = fileno(pZip->m_pState->m_pFile);
+
+    file_ofs += pZip->m_pState->m_file_archive_start_ofs;
+
+    if ((mz_int64)file_ofs < 0)
+        return 0;
+
+    while (total < n)
+    {
+        ssize_t result = pread(fd, (mz_uint8 *)pBuf + total, n - total, (off_t)(file_ofs + total));
+        if ((result < 0) && (errno == EINTR))
+            continue;
+        if (result <= 0)
+            break;
+        total += (size_t)result;
+    }
+
+    return total;
+#else
+    mz_int64 cur_ofs = MZ_FTELL64(pZip->m_pState->m_pFile);
 
     file_ofs += pZip->m_pState->m_file_archive_start_ofs;
 
@@ -3976,6 +5014,7 @@ static size_t mz_zip_file_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBu
         return 0;
 
     return MZ_FREAD(pBuf, 1, n, pZip->m_pState->m_pFile);
+#endif /* #ifdef MINIZ_USE_PREAD */
 }
 
 mz_bool mz_zip_reader_init_file(mz_zip_archive *pZip, const char *pFilename, mz_uint32 flags)
@@ -4028,6 +5067,10 @@ mz_bool mz_zip_reader_init_file_v2(mz_zip_archive *pZip, const char *pFilename,
     pZip->m_archive_size = file_size;
     pZip->m_pState->m_file_archive_start_ofs = file_start_ofs;
 
+#ifdef MINIZ_USE_MMAP
+    mz_zip_file_map(pZip);
+#endif
+
     if (!mz_zip_reader_read_central_dir(pZip, flags))
     {
         mz_zip_reader_end_internal(pZip, MZ_FALSE);
@@ -4168,6 +5211,79 @@ mz_bool mz_zip_reader_is_file_a_directory(mz_zip_archive *pZip, mz_uint file_ind
     return MZ_FALSE;
 }
 
+/* Replaces the sizes and the local header offset that are saturated to MZ_UINT32_MAX in a central directory record with the ones in its zip64 extended information field. */
+static mz_bool mz_zip_read_zip64_extra_data(mz_zip_archive *pZip, const mz_uint8 *p, mz_uint64 *pComp_size, mz_uint64 *pUncomp_size, mz_uint64 *pLocal_header_ofs, mz_bool *pFound_zip64_extra_data)
+{
+    /* Attempt to find zip64 extended information field in the entry's extra data */
+    mz_uint32 extra_size_remaining = MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+
+    if (extra_size_remaining)
+    {
+        const mz_uint8 *pExtra_data = p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+
+        do
+        {
+            mz_uint32 field_id;
+            mz_uint32 field_data_size;
+
+            if (extra_size_remaining < (sizeof(mz_uint16) * 2))
+                return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+            field_id = MZ_READ_LE16(pExtra_data);
+            field_data_size = MZ_READ_LE16(pExtra_data + sizeof(mz_uint16));
+
+            if ((field_data_size + sizeof(mz_uint16) * 2) > extra_size_remaining)
+                return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+            if (field_id == MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID)
+            {
+                const mz_uint8 *pField_data = pExtra_data + sizeof(mz_uint16) * 2;
+                mz_uint32 field_data_remaining = field_data_size;
+
+                if (pFound_zip64_extra_data)
+                    *pFound_zip64_extra_data = MZ_TRUE;
+
+                if (*pUncomp_size == MZ_UINT32_MAX)
+                {
+                    if (field_data_remaining < sizeof(mz_uint64))
+                        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+                    *pUncomp_size = MZ_READ_LE64(pField_data);
+                    pField_data += sizeof(mz_uint64);
+                    field_data_remaining -= sizeof(mz_uint64);
+                }
+
+                if (*pComp_size == MZ_UINT32_MAX)
+                {
+                    if (field_data_remaining < sizeof(mz_uint64))
+                        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+                    *pComp_size = MZ_READ_LE64(pField_data);
+                    pField_data += sizeof(mz_uint64);
+                    field_data_remaining -= sizeof(mz_uint64);
+                }
+
+                if (*pLocal_header_ofs == MZ_UINT32_MAX)
+                {
+                    if (field_data_remaining < sizeof(mz_uint64))
+                        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+                    *pLocal_header_ofs = MZ_READ_LE64(pField_data);
+                    pField_data += sizeof(mz_uint64);
+                    field_data_remaining -= sizeof(mz_uint64);
+                }
+
+                break;
+            }
+
+            pExtra_data += sizeof(mz_uint16) * 2 + field_data_size;
+            extra_size_remaining = extra_size_remaining - sizeof(mz_uint16) * 2 - field_data_size;
+        } while (extra_size_remaining);
+    }
+
+    return MZ_TRUE;
+}
+
 static mz_bool mz_zip_file_stat_internal(mz_zip_archive *pZip, mz_uint file_index, const mz_uint8 *pCentral_dir_header, mz_zip_archive_file_stat *pStat, mz_bool *pFound_zip64_extra_data)
 {
     mz_uint n;
@@ -4217,72 +5333,8 @@ static mz_bool mz_zip_file_stat_internal(mz_zip_archive *pZip, mz_uint file_inde
     /* Confusingly, these zip64 fields can be present even on non-zip64 archives (Debian zip on a huge files from stdin piped to stdout creates them). */
     if (MZ_MAX(MZ_MAX(pStat->m_comp_size, pStat->m_uncomp_size), pStat->m_local_header_ofs) == MZ_UINT32_MAX)
     {
-        /* Attempt to find zip64 extended information field in the entry's extra data */
-        mz_uint32 extra_size_remaining = MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS);
-
-        if (extra_size_remaining)
-        {
-            const mz_uint8 *pExtra_data = p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
-
-            do
-            {
-                mz_uint32 field_id;
-                mz_uint32 field_data_size;
-
-                if (extra_size_remaining < (sizeof(mz_uint16) * 2))
-                    return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-                field_id = MZ_READ_LE16(pExtra_data);
-                field_data_size = MZ_READ_LE16(pExtra_data + sizeof(mz_uint16));
-
-                if ((field_data_size + sizeof(mz_uint16) * 2) > extra_size_remaining)
-                    return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-                if (field_id == MZ_ZIP64_EXTENDED_INFORMATION_FIELD_HEADER_ID)
-                {
-                    const mz_uint8 *pField_data = pExtra_data + sizeof(mz_uint16) * 2;
-                    mz_uint32 field_data_remaining = field_data_size;
-
-                    if (pFound_zip64_extra_data)
-                        *pFound_zip64_extra_data = MZ_TRUE;
-
-                    if (pStat->m_uncomp_size == MZ_UINT32_MAX)
-                    {
-                        if (field_data_remaining < sizeof(mz_uint64))
-                            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-                        pStat->m_uncomp_size = MZ_READ_LE64(pField_data);
-                        pField_data += sizeof(mz_uint64);
-                        field_data_remaining -= sizeof(mz_uint64);
-                    }
-
-                    if (pStat->m_comp_size == MZ_UINT32_MAX)
-                    {
-                        if (field_data_remaining < sizeof(mz_uint64))
-                            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-                        pStat->m_comp_size = MZ_READ_LE64(pField_data);
-                        pField_data += sizeof(mz_uint64);
-                        field_data_remaining -= sizeof(mz_uint64);
-                    }
-
-                    if (pStat->m_local_header_ofs == MZ_UINT32_MAX)
-                    {
-                        if (field_data_remaining < sizeof(mz_uint64))
-                            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-                        pStat->m_local_header_ofs = MZ_READ_LE64(pField_data);
-                        pField_data += sizeof(mz_uint64);
-                        field_data_remaining -= sizeof(mz_uint64);
-                    }
-
-                    break;
-                }
-
-                pExtra_data += sizeof(mz_uint16) * 2 + field_data_size;
-                extra_size_remaining = extra_size_remaining - sizeof(mz_uint16) * 2 - field_data_size;
-            } while (extra_size_remaining);
-        }
+        if (!mz_zip_read_zip64_extra_data(pZip, p, &pStat->m_comp_size, &pStat->m_uncomp_size, &pStat->m_local_header_ofs, pFound_zip64_extra_data))
+            return MZ_FALSE;
     }
 
     return MZ_TRUE;
@@ -4764,7 +5816,7 @@ mz_bool mz_zip_reader_extract_to_callback(mz_zip_archive *pZip, mz_uint file_ind
         tinfl_decompressor inflator;
         tinfl_init(&inflator);
 
-        if (NULL == (pWrite_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, TINFL_LZ_DICT_SIZE)))
+        if (NULL == (pWrite_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, MZ_ZIP_INFLATE_BUF_SIZE)))
         {
             mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
             status = TINFL_STATUS_FAILED;
@@ -4773,8 +5825,8 @@ mz_bool mz_zip_reader_extract_to_callback(mz_zip_archive *pZip, mz_uint file_ind
         {
             do
             {
-                mz_uint8 *pWrite_buf_cur = (mz_uint8 *)pWrite_buf + (out_buf_ofs & (TINFL_LZ_DICT_SIZE - 1));
-                size_t in_buf_size, out_buf_size = TINFL_LZ_DICT_SIZE - (out_buf_ofs & (TINFL_LZ_DICT_SIZE - 1));
+                mz_uint8 *pWrite_buf_cur = (mz_uint8 *)pWrite_buf + (out_buf_ofs & (MZ_ZIP_INFLATE_BUF_SIZE - 1));
+                size_t in_buf_size, out_buf_size = MZ_ZIP_INFLATE_BUF_SIZE - (out_buf_ofs & (MZ_ZIP_INFLATE_BUF_SIZE - 1));
                 if ((!read_buf_avail) && (!pZip->m_pState->m_pMem))
                 {
                     read_buf_avail = MZ_MIN(read_buf_size, comp_remaining);
@@ -4967,7 +6019,7 @@ mz_zip_reader_extract_iter_state* mz_zip_reader_extract_iter_new(mz_zip_archive
         tinfl_init( &pState->inflator );
 
         /* Allocate write buffer */
-        if (NULL == (pState->pWrite_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, TINFL_LZ_DICT_SIZE)))
+        if (NULL == (pState->pWrite_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, MZ_ZIP_INFLATE_BUF_SIZE)))
         {
             mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
             if (pState->pRead_buf)
@@ -5040,10 +6092,10 @@ size_t mz_zip_reader_extract_iter_read(mz_zip_reader_extract_iter_state* pState,
         do
         {
             /* Calc ptr to write buffer - given current output pos and block size */
-            mz_uint8 *pWrite_buf_cur = (mz_uint8 *)pState->pWrite_buf + (pState->out_buf_ofs & (TINFL_LZ_DICT_SIZE - 1));
+            mz_uint8 *pWrite_buf_cur = (mz_uint8 *)pState->pWrite_buf + (pState->out_buf_ofs & (MZ_ZIP_INFLATE_BUF_SIZE - 1));
 
             /* Calc max output size - given current output pos and block size */
-            size_t in_buf_size, out_buf_size = TINFL_LZ_DICT_SIZE - (pState->out_buf_ofs & (TINFL_LZ_DICT_SIZE - 1));
+            size_t in_buf_size, out_buf_size = MZ_ZIP_INFLATE_BUF_SIZE - (pState->out_buf_ofs & (MZ_ZIP_INFLATE_BUF_SIZE - 1));
 
             if (!pState->out_blk_remain)
             {
@@ -5150,6 +6202,425 @@ mz_bool mz_zip_reader_extract_iter_free(mz_zip_reader_extract_iter_state* pState
     return status == TINFL_STATUS_DONE;
 }
 
+#define MZ_ZIP_SEEK_DEFAULT_CHECKPOINT_INTERVAL (4 * 1024 * 1024)
+
+enum
+{
+    /* Saved checkpoints: signature ("MZSK"), version, count, the CRC-32, compressed and uncompressed sizes of their file, the interval, then the */
+    /* CRC-32 of everything else saved. Each checkpoint is its compressed offset in bits, its uncompressed offset and the dictionary. */
+    MZ_ZIP_SEEK_CHECKPOINTS_SIG = 0x4b535a4d,
+    MZ_ZIP_SEEK_CHECKPOINTS_VERSION = 2,
+    MZ_ZIP_SEEK_CHECKPOINTS_CRC32_OFS = 40,
+    MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE = 44,
+    MZ_ZIP_SEEK_CHECKPOINT_SIZE = (sizeof(mz_uint64) * 2 + TINFL_LZ_DICT_SIZE)
+};
+
+/* Checkpoints are at the start of deflate blocks, so only the input position (to the bit) and the last TINFL_LZ_DICT_SIZE bytes of output */
+/* are needed to resume inflating there, with tinfl_init_at_block_start(). */
+typedef struct
+{
+    mz_uint64 m_in_bit_ofs, m_out_ofs;
+    mz_uint8 m_dict[TINFL_LZ_DICT_SIZE];
+} mz_zip_reader_seek_checkpoint;
+
+struct mz_zip_reader_seek_state_tag
+{
+    mz_zip_archive *m_pZip;
+    mz_uint64 m_data_ofs, m_comp_size, m_uncomp_size, m_checkpoint_interval;
+    mz_uint32 m_crc32;
+    mz_uint m_method;
+    mz_zip_array m_checkpoints;
+
+    /* Where inflating stopped, the next read goes on from there if it's on its way */
+    tinfl_status m_status;
+    mz_uint64 m_in_ofs, m_out_ofs;
+    tinfl_decompressor m_inflator;
+    mz_uint8 m_dict[TINFL_LZ_DICT_SIZE];
+
+    /* The compressed data read from m_in_buf_ofs, unless the archive is in memory */
+    mz_uint8 *m_pIn_buf;
+    size_t m_in_buf_size, m_in_buf_avail;
+    mz_uint64 m_in_buf_ofs;
+};
+
+static mz_bool mz_zip_reader_seek_get_input(mz_zip_reader_seek_state *pState, const mz_uint8 **ppIn, size_t *pIn_size);
+
+/* Resumes inflating at a checkpoint, reading the byte its first bits are in if it isn't at a byte boundary. */
+static mz_bool mz_zip_reader_seek_restore(mz_zip_reader_seek_state *pState, const mz_zip_reader_seek_checkpoint *pCheckpoint)
+{
+    mz_uint num_bits = (8 - (mz_uint)(pCheckpoint->m_in_bit_ofs & 7)) & 7;
+    mz_uint32 bit_buf = 0;
+
+    pState->m_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    pState->m_in_ofs = pCheckpoint->m_in_bit_ofs >> 3;
+    pState->m_out_ofs = pCheckpoint->m_out_ofs;
+    memcpy(pState->m_dict, pCheckpoint->m_dict, TINFL_LZ_DICT_SIZE);
+
+    if (num_bits)
+    {
+        const mz_uint8 *pIn;
+        size_t in_size;
+        if (!mz_zip_reader_seek_get_input(pState, &pIn, &in_size))
+        {
+            pState->m_status = TINFL_STATUS_FAILED;
+            return MZ_FALSE;
+        }
+        bit_buf = pIn[0] >> (8 - num_bits);
+        pState->m_in_ofs++;
+    }
+
+    tinfl_init_at_block_start(&pState->m_inflator, bit_buf, num_bits);
+    return MZ_TRUE;
+}
+
+static mz_bool mz_zip_reader_seek_add_checkpoint(mz_zip_reader_seek_state *pState, mz_uint64 in_bit_ofs)
+{
+    mz_zip_array *pCheckpoints = &pState->m_checkpoints;
+    mz_zip_reader_seek_checkpoint *pCheckpoint;
+
+    if (!mz_zip_array_resize(pState->m_pZip, pCheckpoints, pCheckpoints->m_size + 1, MZ_TRUE))
+        return mz_zip_set_error(pState->m_pZip, MZ_ZIP_ALLOC_FAILED);
+
+    pCheckpoint = &MZ_ZIP_ARRAY_ELEMENT(pCheckpoints, mz_zip_reader_seek_checkpoint, pCheckpoints->m_size - 1);
+    pCheckpoint->m_in_bit_ofs = in_bit_ofs;
+    pCheckpoint->m_out_ofs = pState->m_out_ofs;
+    memcpy(pCheckpoint->m_dict, pState->m_dict, TINFL_LZ_DICT_SIZE);
+
+    return MZ_TRUE;
+}
+
+/* Points *ppIn at the compressed data from m_in_ofs on, reading the next chunk of it if the archive isn't in memory. */
+static mz_bool mz_zip_reader_seek_get_input(mz_zip_reader_seek_state *pState, const mz_uint8 **ppIn, size_t *pIn_size)
+{
+    mz_zip_archive *pZip = pState->m_pZip;
+
+    if (pZip->m_pState->m_pMem)
+    {
+        *ppIn = (const mz_uint8 *)pZip->m_pState->m_pMem + pState->m_data_ofs + pState->m_in_ofs;
+        *pIn_size = (size_t)(pState->m_comp_size - pState->m_in_ofs);
+        return MZ_TRUE;
+    }
+
+    if ((pState->m_in_ofs < pState->m_in_buf_ofs) || (pState->m_in_ofs >= pState->m_in_buf_ofs + pState->m_in_buf_avail))
+    {
+        pState->m_in_buf_ofs = pState->m_in_ofs;
+        pState->m_in_buf_avail = (size_t)MZ_MIN(pState->m_comp_size - pState->m_in_ofs, (mz_uint64)pState->m_in_buf_size);
+        if (pZip->m_pRead(pZip->m_pIO_opaque, pState->m_data_ofs + pState->m_in_buf_ofs, pState->m_pIn_buf, pState->m_in_buf_avail) != pState->m_in_buf_avail)
+        {
+            pState->m_in_buf_avail = 0;
+            return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+        }
+    }
+
+    *ppIn = pState->m_pIn_buf + (size_t)(pState->m_in_ofs - pState->m_in_buf_ofs);
+    *pIn_size = (size_t)(pState->m_in_buf_ofs + pState->m_in_buf_avail - pState->m_in_ofs);
+    return MZ_TRUE;
+}
+
+/* Inflates from the current position until file_ofs + buf_size, copying the output from file_ofs on to pBuf, and recording */
+/* a checkpoint at the first block start once the output is checkpoint_interval bytes past the last one. */
+/* file_ofs may be up to TINFL_LZ_DICT_SIZE bytes before the current position, that output is still in the dictionary. */
+static size_t mz_zip_reader_seek_inflate(mz_zip_reader_seek_state *pState, mz_uint64 file_ofs, mz_uint8 *pBuf, size_t buf_size)
+{
+    mz_uint64 end_ofs = file_ofs + buf_size, ofs;
+    size_t copied = 0;
+
+    for (ofs = file_ofs; ofs < MZ_MIN(pState->m_out_ofs, end_ofs); ofs += copied)
+    {
+        size_t dict_ofs = (size_t)(ofs & (TINFL_LZ_DICT_SIZE - 1));
+        copied = (size_t)MZ_MIN(MZ_MIN(pState->m_out_ofs, end_ofs) - ofs, (mz_uint64)(TINFL_LZ_DICT_SIZE - dict_ofs));
+        memcpy(pBuf + (size_t)(ofs - file_ofs), pState->m_dict + dict_ofs, copied);
+    }
+    copied = (size_t)(ofs - file_ofs);
+
+    while ((pState->m_out_ofs < end_ofs) && (pState->m_status > TINFL_STATUS_DONE))
+    {
+        const mz_uint8 *pIn;
+        size_t in_size, dict_ofs = (size_t)(pState->m_out_ofs & (TINFL_LZ_DICT_SIZE - 1)), out_size = TINFL_LZ_DICT_SIZE - dict_ofs;
+        mz_uint64 out_ofs = pState->m_out_ofs, last_checkpoint_ofs;
+        mz_uint flags;
+
+        if (!mz_zip_reader_seek_get_input(pState, &pIn, &in_size))
+        {
+            pState->m_status = TINFL_STATUS_FAILED;
+            return copied;
+        }
+
+        last_checkpoint_ofs = MZ_ZIP_ARRAY_ELEMENT(&pState->m_checkpoints, mz_zip_reader_seek_checkpoint, pState->m_checkpoints.m_size - 1).m_out_ofs;
+        flags = (pState->m_in_ofs + in_size < pState->m_comp_size) ? TINFL_FLAG_HAS_MORE_INPUT : 0;
+        if (pState->m_out_ofs >= last_checkpoint_ofs + pState->m_checkpoint_interval)
+            flags |= TINFL_FLAG_STOP_AT_BLOCK_START;
+        pState->m_status = tinfl_decompress(&pState->m_inflator, pIn, &in_size, pState->m_dict, pState->m_dict + dict_ofs, &out_size, flags);
+        pState->m_in_ofs += in_size;
+        pState->m_out_ofs += out_size;
+
+        if ((pState->m_status < TINFL_STATUS_DONE) || (pState->m_out_ofs > pState->m_uncomp_size))
+        {
+            pState->m_status = TINFL_STATUS_FAILED;
+            mz_zip_set_error(pState->m_pZip, MZ_ZIP_DECOMPRESSION_FAILED);
+            return copied;
+        }
+
+        if (pState->m_out_ofs > file_ofs)
+        {
+            mz_uint64 copy_from = MZ_MAX(out_ofs, file_ofs), copy_to = MZ_MIN(pState->m_out_ofs, end_ofs);
+            memcpy(pBuf + (size_t)(copy_from - file_ofs), pState->m_dict + dict_ofs + (size_t)(copy_from - out_ofs), (size_t)(copy_to - copy_from));
+            copied = (size_t)(copy_to - file_ofs);
+        }
+
+        if ((pState->m_status == TINFL_STATUS_BLOCK_START) && (pState->m_out_ofs >= last_checkpoint_ofs + pState->m_checkpoint_interval))
+        {
+            if (!mz_zip_reader_seek_add_checkpoint(pState, pState->m_in_ofs * 8 - pState->m_inflator.m_num_bits))
+            {
+                pState->m_status = TINFL_STATUS_FAILED;
+                return copied;
+            }
+        }
+    }
+
+    return copied;
+}
+
+mz_zip_reader_seek_state *mz_zip_reader_seek_new(mz_zip_archive *pZip, mz_uint file_index, mz_uint64 checkpoint_interval)
+{
+    mz_zip_archive_file_stat file_stat;
+    mz_zip_reader_seek_state *pState;
+    mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
+    mz_uint8 *pLocal_header = (mz_uint8 *)local_header_u32;
+    mz_uint64 data_ofs;
+
+    if ((!pZip) || (!pZip->m_pState) || (!pZip->m_pRead))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    if (!mz_zip_reader_file_stat(pZip, file_index, &file_stat))
+        return NULL;
+
+    if (file_stat.m_bit_flag & (MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_IS_ENCRYPTED | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_USES_STRONG_ENCRYPTION | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_COMPRESSED_PATCH_FLAG))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_ENCRYPTION);
+        return NULL;
+    }
+
+    if (((file_stat.m_method != 0) && (file_stat.m_method != MZ_DEFLATED)) || ((!file_stat.m_method) && (file_stat.m_comp_size != file_stat.m_uncomp_size)))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_METHOD);
+        return NULL;
+    }
+
+    if (pZip->m_pRead(pZip->m_pIO_opaque, file_stat.m_local_header_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+        return NULL;
+    }
+
+    if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+        return NULL;
+    }
+
+    data_ofs = file_stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+    if ((data_ofs + file_stat.m_comp_size) > pZip->m_archive_size)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+        return NULL;
+    }
+
+    if (NULL == (pState = (mz_zip_reader_seek_state *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(mz_zip_reader_seek_state))))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+        return NULL;
+    }
+
+    memset(pState, 0, sizeof(mz_zip_reader_seek_state));
+    pState->m_pZip = pZip;
+    pState->m_data_ofs = data_ofs;
+    pState->m_comp_size = file_stat.m_comp_size;
+    pState->m_uncomp_size = file_stat.m_uncomp_size;
+    pState->m_checkpoint_interval = checkpoint_interval ? checkpoint_interval : MZ_ZIP_SEEK_DEFAULT_CHECKPOINT_INTERVAL;
+    pState->m_crc32 = file_stat.m_crc32;
+    pState->m_method = file_stat.m_method;
+    MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pState->m_checkpoints, sizeof(mz_zip_reader_seek_checkpoint));
+
+    if (!pState->m_method)
+        return pState;
+
+    if ((!pZip->m_pState->m_pMem) && (file_stat.m_comp_size))
+    {
+        pState->m_in_buf_size = (size_t)MZ_MIN(file_stat.m_comp_size, (mz_uint64)MZ_ZIP_MAX_IO_BUF_SIZE);
+        if (NULL == (pState->m_pIn_buf = (mz_uint8 *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, pState->m_in_buf_size)))
+        {
+            mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+            mz_zip_reader_seek_free(pState);
+            return NULL;
+        }
+    }
+
+    /* The first checkpoint is the start of the data */
+    tinfl_init(&pState->m_inflator);
+    pState->m_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    if (!mz_zip_reader_seek_add_checkpoint(pState, 0))
+    {
+        mz_zip_reader_seek_free(pState);
+        return NULL;
+    }
+
+    return pState;
+}
+
+size_t mz_zip_reader_seek_read(mz_zip_reader_seek_state *pState, mz_uint64 file_ofs, void *pBuf, size_t buf_size)
+{
+    mz_zip_archive *pZip;
+    const mz_zip_reader_seek_checkpoint *pCheckpoint;
+    size_t lo, hi;
+
+    if ((!pState) || ((!pBuf) && (buf_size)) || (file_ofs >= pState->m_uncomp_size))
+        return 0;
+
+    pZip = pState->m_pZip;
+    buf_size = (size_t)MZ_MIN((mz_uint64)buf_size, pState->m_uncomp_size - file_ofs);
+
+    if (!pState->m_method)
+    {
+        if (pZip->m_pRead(pZip->m_pIO_opaque, pState->m_data_ofs + file_ofs, pBuf, buf_size) != buf_size)
+        {
+            mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+            return 0;
+        }
+        return buf_size;
+    }
+
+    /* Find the last checkpoint at or before file_ofs */
+    lo = 0;
+    hi = pState->m_checkpoints.m_size - 1;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (MZ_ZIP_ARRAY_ELEMENT(&pState->m_checkpoints, mz_zip_reader_seek_checkpoint, mid).m_out_ofs <= file_ofs)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    pCheckpoint = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_checkpoints, mz_zip_reader_seek_checkpoint, lo);
+
+    /* Sequential reads go on from where the last one stopped */
+    if ((pState->m_out_ofs > file_ofs + TINFL_LZ_DICT_SIZE) || (pState->m_out_ofs < pCheckpoint->m_out_ofs) || (pState->m_status < TINFL_STATUS_DONE))
+    {
+        if (!mz_zip_reader_seek_restore(pState, pCheckpoint))
+            return 0;
+    }
+
+    return mz_zip_reader_seek_inflate(pState, file_ofs, (mz_uint8 *)pBuf, buf_size);
+}
+
+mz_bool mz_zip_reader_seek_free(mz_zip_reader_seek_state *pState)
+{
+    mz_zip_archive *pZip;
+
+    if (!pState)
+        return MZ_FALSE;
+
+    pZip = pState->m_pZip;
+    mz_zip_array_clear(pZip, &pState->m_checkpoints);
+    if (pState->m_pIn_buf)
+        pZip->m_pFree(pZip->m_pAlloc_opaque, pState->m_pIn_buf);
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pState);
+
+    return MZ_TRUE;
+}
+
+size_t mz_zip_reader_seek_save_checkpoints(mz_zip_reader_seek_state *pState, void *pBuf, size_t buf_size)
+{
+    mz_uint8 *pDst = (mz_uint8 *)pBuf;
+    size_t i, size;
+    mz_uint32 data_crc32;
+
+    if (!pState)
+        return 0;
+
+    size = MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE + pState->m_checkpoints.m_size * MZ_ZIP_SEEK_CHECKPOINT_SIZE;
+    if ((!pDst) || (buf_size < size))
+        return size;
+
+    MZ_WRITE_LE32(pDst + 0, MZ_ZIP_SEEK_CHECKPOINTS_SIG);
+    MZ_WRITE_LE32(pDst + 4, MZ_ZIP_SEEK_CHECKPOINTS_VERSION);
+    MZ_WRITE_LE32(pDst + 8, pState->m_checkpoints.m_size);
+    MZ_WRITE_LE32(pDst + 12, pState->m_crc32);
+    MZ_WRITE_LE64(pDst + 16, pState->m_comp_size);
+    MZ_WRITE_LE64(pDst + 24, pState->m_uncomp_size);
+    MZ_WRITE_LE64(pDst + 32, pState->m_checkpoint_interval);
+
+    for (i = 0; i < pState->m_checkpoints.m_size; ++i)
+    {
+        const mz_zip_reader_seek_checkpoint *pCheckpoint = &MZ_ZIP_ARRAY_ELEMENT(&pState->m_checkpoints, mz_zip_reader_seek_checkpoint, i);
+        mz_uint8 *pDst_checkpoint = pDst + MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE + i * MZ_ZIP_SEEK_CHECKPOINT_SIZE;
+        MZ_WRITE_LE64(pDst_checkpoint + 0, pCheckpoint->m_in_bit_ofs);
+        MZ_WRITE_LE64(pDst_checkpoint + 8, pCheckpoint->m_out_ofs);
+        memcpy(pDst_checkpoint + 16, pCheckpoint->m_dict, TINFL_LZ_DICT_SIZE);
+    }
+
+    data_crc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, pDst, MZ_ZIP_SEEK_CHECKPOINTS_CRC32_OFS);
+    data_crc32 = (mz_uint32)mz_crc32(data_crc32, pDst + MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE, size - MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE);
+    MZ_WRITE_LE32(pDst + MZ_ZIP_SEEK_CHECKPOINTS_CRC32_OFS, data_crc32);
+
+    return size;
+}
+
+mz_bool mz_zip_reader_seek_load_checkpoints(mz_zip_reader_seek_state *pState, const void *pBuf, size_t buf_size)
+{
+    const mz_uint8 *pSrc = (const mz_uint8 *)pBuf;
+    mz_zip_array *pCheckpoints;
+    mz_uint64 last_in_bit_ofs = 0, last_out_ofs = 0;
+    mz_uint32 i, count, data_crc32;
+
+    if ((!pState) || (!pState->m_method) || (!pSrc) || (buf_size < MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE))
+        return MZ_FALSE;
+
+    count = MZ_READ_LE32(pSrc + 8);
+    if ((MZ_READ_LE32(pSrc + 0) != MZ_ZIP_SEEK_CHECKPOINTS_SIG) || (MZ_READ_LE32(pSrc + 4) != MZ_ZIP_SEEK_CHECKPOINTS_VERSION) || (!count) ||
+        ((buf_size - MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE) / MZ_ZIP_SEEK_CHECKPOINT_SIZE != count) ||
+        ((buf_size - MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE) % MZ_ZIP_SEEK_CHECKPOINT_SIZE) ||
+        (MZ_READ_LE32(pSrc + 12) != pState->m_crc32) || (MZ_READ_LE64(pSrc + 16) != pState->m_comp_size) ||
+        (MZ_READ_LE64(pSrc + 24) != pState->m_uncomp_size) || (!MZ_READ_LE64(pSrc + 32)))
+        return mz_zip_set_error(pState->m_pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    data_crc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, pSrc, MZ_ZIP_SEEK_CHECKPOINTS_CRC32_OFS);
+    data_crc32 = (mz_uint32)mz_crc32(data_crc32, pSrc + MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE, buf_size - MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE);
+    if (data_crc32 != MZ_READ_LE32(pSrc + MZ_ZIP_SEEK_CHECKPOINTS_CRC32_OFS))
+        return mz_zip_set_error(pState->m_pZip, MZ_ZIP_CRC_CHECK_FAILED);
+
+    /* Checkpoints start at the beginning and go forward within the data, each past the first resuming with at least one bit of input left */
+    for (i = 0; i < count; ++i)
+    {
+        const mz_uint8 *pSrc_checkpoint = pSrc + MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE + (size_t)i * MZ_ZIP_SEEK_CHECKPOINT_SIZE;
+        mz_uint64 in_bit_ofs = MZ_READ_LE64(pSrc_checkpoint + 0), out_ofs = MZ_READ_LE64(pSrc_checkpoint + 8);
+        if ((i ? ((in_bit_ofs <= last_in_bit_ofs) || (out_ofs <= last_out_ofs) || ((in_bit_ofs >> 3) >= pState->m_comp_size)) : (in_bit_ofs || out_ofs)) ||
+            (out_ofs > pState->m_uncomp_size))
+            return mz_zip_set_error(pState->m_pZip, MZ_ZIP_INVALID_PARAMETER);
+        last_in_bit_ofs = in_bit_ofs;
+        last_out_ofs = out_ofs;
+    }
+
+    pCheckpoints = &pState->m_checkpoints;
+    if (!mz_zip_array_resize(pState->m_pZip, pCheckpoints, count, MZ_FALSE))
+        return mz_zip_set_error(pState->m_pZip, MZ_ZIP_ALLOC_FAILED);
+
+    for (i = 0; i < count; ++i)
+    {
+        const mz_uint8 *pSrc_checkpoint = pSrc + MZ_ZIP_SEEK_CHECKPOINTS_HEADER_SIZE + (size_t)i * MZ_ZIP_SEEK_CHECKPOINT_SIZE;
+        mz_zip_reader_seek_checkpoint *pCheckpoint = &MZ_ZIP_ARRAY_ELEMENT(pCheckpoints, mz_zip_reader_seek_checkpoint, i);
+        pCheckpoint->m_in_bit_ofs = MZ_READ_LE64(pSrc_checkpoint + 0);
+        pCheckpoint->m_out_ofs = MZ_READ_LE64(pSrc_checkpoint + 8);
+        memcpy(pCheckpoint->m_dict, pSrc_checkpoint + 16, TINFL_LZ_DICT_SIZE);
+    }
+
+    pState->m_checkpoint_interval = MZ_READ_LE64(pSrc + 32);
+    return mz_zip_reader_seek_restore(pState, &MZ_ZIP_ARRAY_ELEMENT(pCheckpoints, mz_zip_reader_seek_checkpoint, 0));
+}
+
 #ifndef MINIZ_NO_STDIO
 static size_t mz_zip_file_write_callback(void *pOpaque, mz_uint64 ofs, const void *pBuf, size_t n)
 {
@@ -5158,11 +6629,166 @@ static size_t mz_zip_file_write_callback(void *pOpaque, mz_uint64 ofs, const voi
     return MZ_FWRITE(pBuf, 1, n, (MZ_FILE *)pOpaque);
 }
 
+#ifdef MINIZ_USE_COPY_FILE_RANGE
+/* Copies n bytes at src_ofs of src_fd to dst_fd, at *pDst_ofs (advanced past them) or at its current position when pDst_ofs is NULL. */
+/* Uses copy_file_range(), which shares the extents on file systems with reflinks, or sendfile() where that isn't supported (across file systems on older kernels) and pDst_ofs is NULL. */
+/* Returns -1 if nothing could be copied, 0 on a failure after that. */
+static int mz_zip_copy_file_range(int src_fd, mz_uint64 src_ofs, int dst_fd, mz_uint64 *pDst_ofs, mz_uint64 n)
+{
+    loff_t src_pos = (loff_t)src_ofs, dst_pos = pDst_ofs ? (loff_t)*pDst_ofs : 0;
+    mz_bool use_sendfile = MZ_FALSE, copied = MZ_FALSE;
+
+    while (n)
+    {
+        size_t chunk = (size_t)MZ_MIN(n, (mz_uint64)0x40000000);
+        ssize_t result;
+
+        if (!use_sendfile)
+            result = copy_file_range(src_fd, &src_pos, dst_fd, pDst_ofs ? &dst_pos : NULL, chunk, 0);
+        else
+        {
+            off_t ofs = (off_t)src_pos;
+            result = sendfile(dst_fd, src_fd, &ofs, chunk);
+            if (result > 0)
+                src_pos = (loff_t)ofs;
+        }
+
+        if ((result < 0) && (errno == EINTR))
+            continue;
+        if ((result < 0) && (!use_sendfile) && (!pDst_ofs) && (!copied) && ((errno == EXDEV) || (errno == ENOSYS) || (errno == EINVAL) || (errno == EOPNOTSUPP)))
+        {
+            use_sendfile = MZ_TRUE;
+            continue;
+        }
+        if (result <= 0)
+            return copied ? 0 : -1;
+
+        n -= (mz_uint64)result;
+        copied = MZ_TRUE;
+    }
+
+    if (pDst_ofs)
+        *pDst_ofs = (mz_uint64)dst_pos;
+
+    return 1;
+}
+
+/* Extracts a stored entry without passing its data through user space, except for the CRC check (which reads it from the memory mapped archive). */
+/* Returns -1 if that isn't possible, and the stdio path should be taken instead. */
+static int mz_zip_reader_extract_stored_to_file(mz_zip_archive *pZip, const mz_zip_archive_file_stat *pStat, const char *pDst_filename, mz_uint flags)
+{
+    mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
+    mz_uint8 *pLocal_header = (mz_uint8 *)local_header_u32;
+    mz_uint64 cur_file_ofs = pStat->m_local_header_ofs;
+    mz_bool check_crc = MZ_FALSE;
+    int fd, result;
+
+    if ((pZip->m_zip_mode != MZ_ZIP_MODE_READING) || ((pZip->m_zip_type != MZ_ZIP_TYPE_FILE) && (pZip->m_zip_type != MZ_ZIP_TYPE_CFILE)) || (!pZip->m_pState->m_pFile))
+        return -1;
+    if ((pStat->m_comp_size <= MZ_ZIP_MAX_IO_BUF_SIZE) || (pStat->m_bit_flag & (MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_IS_ENCRYPTED | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_USES_STRONG_ENCRYPTION | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_COMPRESSED_PATCH_FLAG)))
+        return -1;
+
+    if (!(flags & MZ_ZIP_FLAG_COMPRESSED_DATA))
+    {
+        if ((pStat->m_method != 0) || (pStat->m_comp_size != pStat->m_uncomp_size))
+            return -1;
+#ifndef MINIZ_DISABLE_ZIP_READER_CRC32_CHECKS
+        /* Reading the data back through stdio for the CRC would cost more than the copy saves. */
+        if (!pZip->m_pState->m_pMem)
+            return -1;
+        check_crc = MZ_TRUE;
+#endif
+    }
+
+    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
+        return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+
+    if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    cur_file_ofs += MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+    if ((cur_file_ofs + pStat->m_comp_size) > pZip->m_archive_size)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    fd = open(pDst_filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0)
+        return -1;
+
+#ifdef MINIZ_USE_FALLOCATE
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)pStat->m_comp_size);
+#endif
+
+    result = mz_zip_copy_file_range(fileno(pZip->m_pState->m_pFile), pZip->m_pState->m_file_archive_start_ofs + cur_file_ofs, fd, NULL, pStat->m_comp_size);
+    if (result < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (!result)
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+    else if ((check_crc) && (mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pZip->m_pState->m_pMem + cur_file_ofs, (size_t)pStat->m_comp_size) != pStat->m_crc32))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_CRC_CHECK_FAILED);
+        result = 0;
+    }
+
+    if ((close(fd) != 0) && (result))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_CLOSE_FAILED);
+        result = 0;
+    }
+
+    return result;
+}
+#endif /* #ifdef MINIZ_USE_COPY_FILE_RANGE */
+
+#ifdef MINIZ_USE_MMAP_EXTRACT
+/* Smaller entries go through the stdio path, mapping them costs more than it saves. */
+#define MZ_ZIP_MMAP_EXTRACT_MIN_SIZE (256 * 1024)
+
+/* Decompresses the entry into the destination file mapped in memory, after allocating its blocks (so a full disk can't fault the mapping). */
+/* Unlike the fallocate hint of the stdio path, this sets the file size up front, as the mapping must cover the whole file. */
+/* Returns -1 if the file couldn't be set up this way, and the stdio path should be taken instead. */
+static int mz_zip_reader_extract_to_mapped_file(mz_zip_archive *pZip, mz_uint file_index, mz_uint64 size, const char *pDst_filename, mz_uint flags)
+{
+    void *pMapping;
+    mz_bool status;
+    int fd;
+
+    if (size > (mz_uint64)(size_t)-1)
+        return -1;
+
+    fd = open(pDst_filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0)
+        return -1;
+
+    if ((posix_fallocate(fd, 0, (off_t)size) != 0) ||
+        ((pMapping = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED))
+    {
+        close(fd);
+        return -1;
+    }
+
+    status = mz_zip_reader_extract_to_mem_no_alloc(pZip, file_index, pMapping, (size_t)size, flags, NULL, 0);
+
+    if ((munmap(pMapping, (size_t)size) != 0) && (status))
+        status = mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+    if ((close(fd) != 0) && (status))
+        status = mz_zip_set_error(pZip, MZ_ZIP_FILE_CLOSE_FAILED);
+
+    return status;
+}
+#endif /* #ifdef MINIZ_USE_MMAP_EXTRACT */
+
 mz_bool mz_zip_reader_extract_to_file(mz_zip_archive *pZip, mz_uint file_index, const char *pDst_filename, mz_uint flags)
 {
     mz_bool status;
     mz_zip_archive_file_stat file_stat;
     MZ_FILE *pFile;
+    mz_uint64 out_size;
+    void *pWrite_buf = NULL;
+    size_t write_buf_size;
 
     if (!mz_zip_reader_file_stat(pZip, file_index, &file_stat))
         return MZ_FALSE;
@@ -5170,10 +6796,50 @@ mz_bool mz_zip_reader_extract_to_file(mz_zip_archive *pZip, mz_uint file_index,
     if ((file_stat.m_is_directory) || (!file_stat.m_is_supported))
         return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_FEATURE);
 
+#ifdef MINIZ_USE_COPY_FILE_RANGE
+    {
+        int result = mz_zip_reader_extract_stored_to_file(pZip, &file_stat, pDst_filename, flags);
+        if (result >= 0)
+        {
+            status = (mz_bool)result;
+            goto done;
+        }
+    }
+#endif
+
+#ifdef MINIZ_USE_MMAP_EXTRACT
+    if ((!(flags & MZ_ZIP_FLAG_COMPRESSED_DATA)) && (file_stat.m_uncomp_size >= MZ_ZIP_MMAP_EXTRACT_MIN_SIZE))
+    {
+        int result = mz_zip_reader_extract_to_mapped_file(pZip, file_index, file_stat.m_uncomp_size, pDst_filename, flags);
+        if (result >= 0)
+        {
+            status = (mz_bool)result;
+            goto done;
+        }
+    }
+#endif
+
     pFile = MZ_FOPEN(pDst_filename, "wb");
     if (!pFile)
         return mz_zip_set_error(pZip, MZ_ZIP_FILE_OPEN_FAILED);
 
+    out_size = (flags & MZ_ZIP_FLAG_COMPRESSED_DATA) ? file_stat.m_comp_size : file_stat.m_uncomp_size;
+    if (out_size > MZ_ZIP_MAX_IO_BUF_SIZE)
+    {
+#ifdef MINIZ_USE_FALLOCATE
+        /* Only a hint: the plain fallocate call fails where posix_fallocate would fall back to writing zeros. */
+        fallocate(fileno(pFile), FALLOC_FL_KEEP_SIZE, 0, (off_t)out_size);
+#endif
+        /* Coalesce the callback sized pieces into big writes. */
+        write_buf_size = (size_t)MZ_MIN(out_size, (mz_uint64)MZ_ZIP_FILE_WRITE_BUF_SIZE);
+        pWrite_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, write_buf_size);
+        if ((pWrite_buf) && (setvbuf(pFile, (char *)pWrite_buf, _IOFBF, write_buf_size) != 0))
+        {
+            pZip->m_pFree(pZip->m_pAlloc_opaque, pWrite_buf);
+            pWrite_buf = NULL;
+        }
+    }
+
     status = mz_zip_reader_extract_to_callback(pZip, file_index, mz_zip_file_write_callback, pFile, flags);
 
     if (MZ_FCLOSE(pFile) == EOF)
@@ -5184,6 +6850,12 @@ mz_bool mz_zip_reader_extract_to_file(mz_zip_archive *pZip, mz_uint file_index,
         status = MZ_FALSE;
     }
 
+    if (pWrite_buf)
+        pZip->m_pFree(pZip->m_pAlloc_opaque, pWrite_buf);
+
+#if defined(MINIZ_USE_COPY_FILE_RANGE) || defined(MINIZ_USE_MMAP_EXTRACT)
+done:
+#endif
 #if !defined(MINIZ_NO_TIME) && !defined(MINIZ_NO_STDIO)
     if (status)
         mz_zip_set_file_times(pDst_filename, file_stat.m_time, file_stat.m_time);
@@ -5579,28 +7251,6 @@ mz_bool mz_zip_validate_file_archive(const char *pFilename, mz_uint flags, mz_zi
 
 #ifndef MINIZ_NO_ARCHIVE_WRITING_APIS
 
-static MZ_FORCEINLINE void mz_write_le16(mz_uint8 *p, mz_uint16 v)
-{
-    p[0] = (mz_uint8)v;
-    p[1] = (mz_uint8)(v >> 8);
-}
-static MZ_FORCEINLINE void mz_write_le32(mz_uint8 *p, mz_uint32 v)
-{
-    p[0] = (mz_uint8)v;
-    p[1] = (mz_uint8)(v >> 8);
-    p[2] = (mz_uint8)(v >> 16);
-    p[3] = (mz_uint8)(v >> 24);
-}
-static MZ_FORCEINLINE void mz_write_le64(mz_uint8 *p, mz_uint64 v)
-{
-    mz_write_le32(p, (mz_uint32)v);
-    mz_write_le32(p + sizeof(mz_uint32), (mz_uint32)(v >> 32));
-}
-
-#define MZ_WRITE_LE16(p, v) mz_write_le16((mz_uint8 *)(p), (mz_uint16)(v))
-#define MZ_WRITE_LE32(p, v) mz_write_le32((mz_uint8 *)(p), (mz_uint32)(v))
-#define MZ_WRITE_LE64(p, v) mz_write_le64((mz_uint8 *)(p), (mz_uint64)(v))
-
 static size_t mz_zip_heap_write_func(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n)
 {
     mz_zip_archive *pZip = (mz_zip_archive *)pOpaque;
@@ -5639,6 +7289,22 @@ static size_t mz_zip_heap_write_func(void *pOpaque, mz_uint64 file_ofs, const vo
     return n;
 }
 
+static tdefl_compressor *mz_zip_writer_get_compressor(mz_zip_archive *pZip)
+{
+    mz_zip_internal_state *pState = pZip->m_pState;
+    if (!pState->m_pCompressor)
+        pState->m_pCompressor = (tdefl_compressor *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tdefl_compressor));
+    return pState->m_pCompressor;
+}
+
+static void *mz_zip_writer_get_io_buf(mz_zip_archive *pZip)
+{
+    mz_zip_internal_state *pState = pZip->m_pState;
+    if (!pState->m_pIO_buf)
+        pState->m_pIO_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, MZ_ZIP_MAX_IO_BUF_SIZE);
+    return pState->m_pIO_buf;
+}
+
 static mz_bool mz_zip_writer_end_internal(mz_zip_archive *pZip, mz_bool set_last_error)
 {
     mz_zip_internal_state *pState;
@@ -5656,6 +7322,8 @@ static mz_bool mz_zip_writer_end_internal(mz_zip_archive *pZip, mz_bool set_last
     mz_zip_array_clear(pZip, &pState->m_central_dir);
     mz_zip_array_clear(pZip, &pState->m_central_dir_offsets);
     mz_zip_array_clear(pZip, &pState->m_sorted_central_dir_offsets);
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pState->m_pCompressor);
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pState->m_pIO_buf);
 
 #ifndef MINIZ_NO_STDIO
     if (pState->m_pFile)
@@ -5703,6 +7371,10 @@ mz_bool mz_zip_writer_init_v2(mz_zip_archive *pZip, mz_uint64 existing_size, mz_
         /* Ensure user specified file offset alignment is a power of 2. */
         if (pZip->m_file_offset_alignment & (pZip->m_file_offset_alignment - 1))
             return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+        /* The padding for aligned data has to fit in a 16-bit extra field. */
+        if ((flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA) && (pZip->m_file_offset_alignment > MZ_ZIP_MAX_DATA_ALIGNMENT))
+            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
     }
 
     if (!pZip->m_pAlloc)
@@ -5725,6 +7397,7 @@ mz_bool mz_zip_writer_init_v2(mz_zip_archive *pZip, mz_uint64 existing_size, mz_
     MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir_offsets, sizeof(mz_uint32));
     MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_sorted_central_dir_offsets, sizeof(mz_uint32));
 
+    pZip->m_pState->m_init_flags = flags;
     pZip->m_pState->m_zip64 = zip64;
     pZip->m_pState->m_zip64_has_extended_info_fields = zip64;
 
@@ -5776,6 +7449,30 @@ mz_bool mz_zip_writer_init_heap(mz_zip_archive *pZip, size_t size_to_reserve_at_
 static size_t mz_zip_file_write_func(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n)
 {
     mz_zip_archive *pZip = (mz_zip_archive *)pOpaque;
+#ifdef MINIZ_USE_PREAD
+    size_t total = 0;
+    int fd = fileno(pZip->m_pState->m_pFile);
+
+    file_ofs += pZip->m_pState->m_file_archive_start_ofs;
+
+    if ((mz_int64)file_ofs < 0)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_SEEK_FAILED);
+        return 0;
+    }
+
+    while (total < n)
+    {
+        ssize_t result = pwrite(fd, (const mz_uint8 *)pBuf + total, n - total, (off_t)(file_ofs + total));
+        if ((result < 0) && (errno == EINTR))
+            continue;
+        if (result <= 0)
+            break;
+        total += (size_t)result;
+    }
+
+    return total;
+#else
     mz_int64 cur_ofs = MZ_FTELL64(pZip->m_pState->m_pFile);
 
     file_ofs += pZip->m_pState->m_file_archive_start_ofs;
@@ -5787,6 +7484,7 @@ static size_t mz_zip_file_write_func(void *pOpaque, mz_uint64 file_ofs, const vo
     }
 
     return MZ_FWRITE(pBuf, 1, n, pZip->m_pState->m_pFile);
+#endif /* #ifdef MINIZ_USE_PREAD */
 }
 
 mz_bool mz_zip_writer_init_file(mz_zip_archive *pZip, const char *pFilename, mz_uint64 size_to_reserve_at_beginning)
@@ -5876,6 +7574,14 @@ mz_bool mz_zip_writer_init_from_reader_v2(mz_zip_archive *pZip, const char *pFil
             return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
     }
 
+    if (flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA)
+    {
+        if ((pZip->m_file_offset_alignment & (pZip->m_file_offset_alignment - 1)) || (pZip->m_file_offset_alignment > MZ_ZIP_MAX_DATA_ALIGNMENT))
+            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+        pZip->m_pState->m_init_flags |= MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA;
+    }
+
     /* No sense in trying to write to an archive that's already at the support max size */
     if (pZip->m_pState->m_zip64)
     {
@@ -5907,6 +7613,12 @@ mz_bool mz_zip_writer_init_from_reader_v2(mz_zip_archive *pZip, const char *pFil
             if (!pFilename)
                 return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
 
+#ifdef MINIZ_USE_MMAP
+            /* The archive is going to grow, go back to stdio for reading as well. */
+            mz_zip_file_unmap(pState);
+            pZip->m_pRead = mz_zip_file_read_func;
+#endif
+
             /* Archive is being read from stdio and was originally opened only for reading. Try to reopen as writable. */
             if (NULL == (pState->m_pFile = MZ_FREOPEN(pFilename, "r+b", pState->m_pFile)))
             {
@@ -6098,6 +7810,29 @@ static mz_bool mz_zip_writer_add_to_central_dir(mz_zip_archive *pZip, const char
     return MZ_TRUE;
 }
 
+mz_bool mz_zip_writer_reserve_central_dir(mz_zip_archive *pZip, mz_uint num_files, mz_uint64 total_filename_size)
+{
+    mz_zip_internal_state *pState;
+    mz_uint64 central_dir_size;
+
+    if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    pState = pZip->m_pState;
+    central_dir_size = pState->m_central_dir.m_size + total_filename_size +
+                       (mz_uint64)num_files * (MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + (pState->m_zip64 ? MZ_ZIP64_MAX_CENTRAL_EXTRA_FIELD_SIZE : 0));
+
+    /* Too big for a central dir anyway, adding the files will fail on its own */
+    if (central_dir_size >= MZ_UINT32_MAX)
+        return MZ_TRUE;
+
+    if ((!mz_zip_array_reserve(pZip, &pState->m_central_dir, (size_t)central_dir_size, MZ_FALSE)) ||
+        (!mz_zip_array_reserve(pZip, &pState->m_central_dir_offsets, pState->m_central_dir_offsets.m_size + num_files, MZ_FALSE)))
+        return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+
+    return MZ_TRUE;
+}
+
 static mz_bool mz_zip_writer_validate_archive_name(const char *pArchive_name)
 {
     /* Basic ZIP archive filename validity checks: Valid filenames cannot start with a forward slash, cannot contain a drive letter, and cannot use DOS-style backward slashes. */
@@ -6112,7 +7847,7 @@ static mz_bool mz_zip_writer_validate_archive_name(const char *pArchive_name)
 static mz_uint mz_zip_writer_compute_padding_needed_for_file_alignment(mz_zip_archive *pZip)
 {
     mz_uint32 n;
-    if (!pZip->m_file_offset_alignment)
+    if ((!pZip->m_file_offset_alignment) || (pZip->m_pState->m_init_flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA))
         return 0;
     n = (mz_uint32)(pZip->m_archive_size & (pZip->m_file_offset_alignment - 1));
     return (mz_uint)((pZip->m_file_offset_alignment - n) & (pZip->m_file_offset_alignment - 1));
@@ -6134,6 +7869,30 @@ static mz_bool mz_zip_writer_write_zeros(mz_zip_archive *pZip, mz_uint64 cur_fil
     return MZ_TRUE;
 }
 
+/* With MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA, the local header of a stored file ends with a zipalign style extra field (id, size, the alignment, then zeros) */
+/* just long enough to move its data at data_ofs up to the next multiple of m_file_offset_alignment. Returns 0 when data isn't aligned. */
+static mz_uint mz_zip_writer_compute_data_alignment_field_size(mz_zip_archive *pZip, mz_uint64 data_ofs)
+{
+    mz_uint32 n;
+    if ((!pZip->m_file_offset_alignment) || (!(pZip->m_pState->m_init_flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA)))
+        return 0;
+    n = (mz_uint32)((data_ofs + MZ_ZIP_DATA_ALIGNMENT_FIELD_MIN_SIZE) & (pZip->m_file_offset_alignment - 1));
+    return MZ_ZIP_DATA_ALIGNMENT_FIELD_MIN_SIZE + (mz_uint)((pZip->m_file_offset_alignment - n) & (pZip->m_file_offset_alignment - 1));
+}
+
+static mz_bool mz_zip_writer_write_data_alignment_field(mz_zip_archive *pZip, mz_uint64 cur_file_ofs, mz_uint field_size)
+{
+    mz_uint8 field[MZ_ZIP_DATA_ALIGNMENT_FIELD_MIN_SIZE];
+
+    MZ_WRITE_LE16(field + 0, MZ_ZIP_DATA_ALIGNMENT_FIELD_HEADER_ID);
+    MZ_WRITE_LE16(field + 2, field_size - sizeof(mz_uint16) * 2);
+    MZ_WRITE_LE16(field + 4, pZip->m_file_offset_alignment);
+    if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_file_ofs, field, sizeof(field)) != sizeof(field))
+        return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+
+    return mz_zip_writer_write_zeros(pZip, cur_file_ofs + sizeof(field), field_size - sizeof(field));
+}
+
 mz_bool mz_zip_writer_add_mem_ex(mz_zip_archive *pZip, const char *pArchive_name, const void *pBuf, size_t buf_size, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags,
                                  mz_uint64 uncomp_size, mz_uint32 uncomp_crc32)
 {
@@ -6145,7 +7904,7 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
                                     const char *user_extra_data, mz_uint user_extra_data_len, const char *user_extra_data_central, mz_uint user_extra_data_central_len)
 {
     mz_uint16 method = 0, dos_time = 0, dos_date = 0;
-    mz_uint level, ext_attributes = 0, num_alignment_padding_bytes;
+    mz_uint level, ext_attributes = 0, num_alignment_padding_bytes, data_alignment_field_size = 0;
     mz_uint64 local_dir_header_ofs = pZip->m_archive_size, cur_archive_file_ofs = pZip->m_archive_size, comp_size = 0;
     size_t archive_name_size;
     mz_uint8 local_dir_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
@@ -6262,18 +8021,15 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
 
     if ((!store_data_uncompressed) && (buf_size))
     {
-        if (NULL == (pComp = (tdefl_compressor *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tdefl_compressor))))
+        if (NULL == (pComp = mz_zip_writer_get_compressor(pZip)))
             return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
     }
 
     if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, num_alignment_padding_bytes))
-    {
-        pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
         return MZ_FALSE;
-    }
 
     local_dir_header_ofs += num_alignment_padding_bytes;
-    if (pZip->m_file_offset_alignment)
+    if ((pZip->m_file_offset_alignment) && (!(pZip->m_pState->m_init_flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA)))
     {
         MZ_ASSERT((local_dir_header_ofs & (pZip->m_file_offset_alignment - 1)) == 0);
     }
@@ -6295,7 +8051,10 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
                                                                (uncomp_size >= MZ_UINT32_MAX) ? &comp_size : NULL, (local_dir_header_ofs >= MZ_UINT32_MAX) ? &local_dir_header_ofs : NULL);
         }
 
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(extra_size + user_extra_data_len), 0, 0, 0, method, bit_flags, dos_time, dos_date))
+        if ((!method) && (buf_size))
+            data_alignment_field_size = mz_zip_writer_compute_data_alignment_field_size(pZip, local_dir_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + archive_name_size + extra_size + user_extra_data_len);
+
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(extra_size + user_extra_data_len + data_alignment_field_size), 0, 0, 0, method, bit_flags, dos_time, dos_date))
             return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
@@ -6304,10 +8063,7 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
         cur_archive_file_ofs += sizeof(local_dir_header);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pArchive_name, archive_name_size) != archive_name_size)
-        {
-            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
             return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
-        }
         cur_archive_file_ofs += archive_name_size;
 
         if (pExtra_data != NULL)
@@ -6322,7 +8078,11 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
     {
         if ((comp_size > MZ_UINT32_MAX) || (cur_archive_file_ofs > MZ_UINT32_MAX))
             return mz_zip_set_error(pZip, MZ_ZIP_ARCHIVE_TOO_LARGE);
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)user_extra_data_len, 0, 0, 0, method, bit_flags, dos_time, dos_date))
+
+        if ((!method) && (buf_size))
+            data_alignment_field_size = mz_zip_writer_compute_data_alignment_field_size(pZip, local_dir_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + archive_name_size + user_extra_data_len);
+
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(user_extra_data_len + data_alignment_field_size), 0, 0, 0, method, bit_flags, dos_time, dos_date))
             return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, local_dir_header_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
@@ -6331,10 +8091,7 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
         cur_archive_file_ofs += sizeof(local_dir_header);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pArchive_name, archive_name_size) != archive_name_size)
-        {
-            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
             return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
-        }
         cur_archive_file_ofs += archive_name_size;
     }
 
@@ -6346,13 +8103,19 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
         cur_archive_file_ofs += user_extra_data_len;
     }
 
+    if (data_alignment_field_size)
+    {
+        if (!mz_zip_writer_write_data_alignment_field(pZip, cur_archive_file_ofs, data_alignment_field_size))
+            return MZ_FALSE;
+
+        cur_archive_file_ofs += data_alignment_field_size;
+        MZ_ASSERT((cur_archive_file_ofs & (pZip->m_file_offset_alignment - 1)) == 0);
+    }
+
     if (store_data_uncompressed)
     {
         if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pBuf, buf_size) != buf_size)
-        {
-            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
             return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
-        }
 
         cur_archive_file_ofs += buf_size;
         comp_size = buf_size;
@@ -6367,18 +8130,12 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
 
         if ((tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY) ||
             (tdefl_compress_buffer(pComp, pBuf, buf_size, TDEFL_FINISH) != TDEFL_STATUS_DONE))
-        {
-            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
             return mz_zip_set_error(pZip, MZ_ZIP_COMPRESSION_FAILED);
-        }
 
         comp_size = state.m_comp_size;
         cur_archive_file_ofs = state.m_cur_archive_file_ofs;
     }
 
-    pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
-    pComp = NULL;
-
     if (uncomp_size)
     {
         mz_uint8 local_dir_footer[MZ_ZIP_DATA_DESCRIPTER_SIZE64];
@@ -6426,11 +8183,52 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
     return MZ_TRUE;
 }
 
-mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pArchive_name, mz_file_read_func read_callback, void* callback_opaque, mz_uint64 size_to_add, const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags,
-                                const char *user_extra_data, mz_uint user_extra_data_len, const char *user_extra_data_central, mz_uint user_extra_data_central_len)
+#ifdef MINIZ_USE_COPY_FILE_RANGE
+static size_t mz_file_read_func_stdio(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n);
+
+/* Stored files are copied into the archive in chunks of this size, each one read back (from the page cache) for the CRC right after. */
+#define MZ_ZIP_WRITER_COPY_CHUNK_SIZE (1024 * 1024)
+
+/* Copies the data of a stored source file into the archive file without writing it through user space, it's only read for the CRC. */
+/* Returns -1 if that isn't possible (having written nothing), and the data should go through the I/O buffer instead. */
+static int mz_zip_writer_copy_file_range(mz_zip_archive *pZip, MZ_FILE *pSrc_file, mz_uint64 cur_archive_file_ofs, mz_uint64 size, mz_uint32 *pCrc32)
+{
+    mz_uint64 src_ofs = 0, dst_ofs = pZip->m_pState->m_file_archive_start_ofs + cur_archive_file_ofs;
+    void *pRead_buf = mz_zip_writer_get_io_buf(pZip);
+
+    if (!pRead_buf)
+        return -1;
+
+    while (src_ofs < size)
+    {
+        mz_uint64 chunk = MZ_MIN(size - src_ofs, (mz_uint64)MZ_ZIP_WRITER_COPY_CHUNK_SIZE), chunk_end = src_ofs + chunk;
+        int result = mz_zip_copy_file_range(fileno(pSrc_file), src_ofs, fileno(pZip->m_pState->m_pFile), &dst_ofs, chunk);
+
+        if ((result < 0) && (!src_ofs))
+            return -1;
+        if (result <= 0)
+            return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+
+        while (src_ofs < chunk_end)
+        {
+            size_t n = (size_t)MZ_MIN(chunk_end - src_ofs, (mz_uint64)MZ_ZIP_MAX_IO_BUF_SIZE);
+            if (mz_file_read_func_stdio(pSrc_file, src_ofs, pRead_buf, n) != n)
+                return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+            *pCrc32 = (mz_uint32)mz_crc32(*pCrc32, (const mz_uint8 *)pRead_buf, n);
+            src_ofs += n;
+        }
+    }
+
+    return MZ_TRUE;
+}
+#endif /* #ifdef MINIZ_USE_COPY_FILE_RANGE */
+
+/* The data comes from read_callback or deflate_callback, with neither it's left for the caller to write at *pData_ofs (only stored). */
+static mz_bool mz_zip_writer_add_callback_internal(mz_zip_archive *pZip, const char *pArchive_name, mz_file_read_func read_callback, mz_zip_deflate_func deflate_callback, void* callback_opaque, mz_uint64 size_to_add, const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags,
+                                const char *user_extra_data, mz_uint user_extra_data_len, const char *user_extra_data_central, mz_uint user_extra_data_central_len, mz_uint64 *pData_ofs)
 {
     mz_uint16 gen_flags = MZ_ZIP_LDH_BIT_FLAG_HAS_LOCATOR;
-    mz_uint uncomp_crc32 = MZ_CRC32_INIT, level, num_alignment_padding_bytes;
+    mz_uint uncomp_crc32 = MZ_CRC32_INIT, level, num_alignment_padding_bytes, data_alignment_field_size = 0;
     mz_uint16 method = 0, dos_time = 0, dos_date = 0, ext_attributes = 0;
     mz_uint64 local_dir_header_ofs, cur_archive_file_ofs = pZip->m_archive_size, uncomp_size = size_to_add, comp_size = 0;
     size_t archive_name_size;
@@ -6452,6 +8250,10 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || (!pArchive_name) || ((comment_size) && (!pComment)) || (level > MZ_UBER_COMPRESSION))
         return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
 
+    /* Data supplied by a deflate callback can't be stored, reserved data can only be */
+    if (((deflate_callback) && (!level)) || ((!read_callback) && (!deflate_callback) && ((level) || (!pData_ofs))))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
     pState = pZip->m_pState;
 
     if ((!pState->m_zip64) && (uncomp_size > MZ_UINT32_MAX))
@@ -6511,7 +8313,7 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     }
 #endif
 
-    if (uncomp_size <= 3)
+    if ((uncomp_size <= 3) && (!deflate_callback))
         level = 0;
 
     if (!mz_zip_writer_write_zeros(pZip, cur_archive_file_ofs, num_alignment_padding_bytes))
@@ -6522,7 +8324,7 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     cur_archive_file_ofs += num_alignment_padding_bytes;
     local_dir_header_ofs = cur_archive_file_ofs;
 
-    if (pZip->m_file_offset_alignment)
+    if ((pZip->m_file_offset_alignment) && (!(pZip->m_pState->m_init_flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA)))
     {
         MZ_ASSERT((cur_archive_file_ofs & (pZip->m_file_offset_alignment - 1)) == 0);
     }
@@ -6542,7 +8344,10 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
                                                                (uncomp_size >= MZ_UINT32_MAX) ? &comp_size : NULL, (local_dir_header_ofs >= MZ_UINT32_MAX) ? &local_dir_header_ofs : NULL);
         }
 
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(extra_size + user_extra_data_len), 0, 0, 0, method, gen_flags, dos_time, dos_date))
+        if ((!method) && (uncomp_size))
+            data_alignment_field_size = mz_zip_writer_compute_data_alignment_field_size(pZip, local_dir_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + archive_name_size + extra_size + user_extra_data_len);
+
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(extra_size + user_extra_data_len + data_alignment_field_size), 0, 0, 0, method, gen_flags, dos_time, dos_date))
             return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
@@ -6566,7 +8371,11 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     {
         if ((comp_size > MZ_UINT32_MAX) || (cur_archive_file_ofs > MZ_UINT32_MAX))
             return mz_zip_set_error(pZip, MZ_ZIP_ARCHIVE_TOO_LARGE);
-        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)user_extra_data_len, 0, 0, 0, method, gen_flags, dos_time, dos_date))
+
+        if ((!method) && (uncomp_size))
+            data_alignment_field_size = mz_zip_writer_compute_data_alignment_field_size(pZip, local_dir_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + archive_name_size + user_extra_data_len);
+
+        if (!mz_zip_writer_create_local_dir_header(pZip, local_dir_header, (mz_uint16)archive_name_size, (mz_uint16)(user_extra_data_len + data_alignment_field_size), 0, 0, 0, method, gen_flags, dos_time, dos_date))
             return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
 
         if (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, local_dir_header, sizeof(local_dir_header)) != sizeof(local_dir_header))
@@ -6590,10 +8399,42 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
         cur_archive_file_ofs += user_extra_data_len;
     }
 
-    if (uncomp_size)
+    if (data_alignment_field_size)
+    {
+        if (!mz_zip_writer_write_data_alignment_field(pZip, cur_archive_file_ofs, data_alignment_field_size))
+            return MZ_FALSE;
+
+        cur_archive_file_ofs += data_alignment_field_size;
+        MZ_ASSERT((cur_archive_file_ofs & (pZip->m_file_offset_alignment - 1)) == 0);
+    }
+
+    if (pData_ofs)
+        *pData_ofs = cur_archive_file_ofs;
+
+    if ((uncomp_size) && (deflate_callback))
+    {
+        mz_zip_writer_add_state state;
+
+        state.m_pZip = pZip;
+        state.m_cur_archive_file_ofs = cur_archive_file_ofs;
+        state.m_comp_size = 0;
+
+        if (!deflate_callback(callback_opaque, mz_zip_writer_add_put_buf_callback, &state, &uncomp_crc32))
+            return mz_zip_set_error(pZip, MZ_ZIP_COMPRESSION_FAILED);
+
+        comp_size = state.m_comp_size;
+        cur_archive_file_ofs = state.m_cur_archive_file_ofs;
+    }
+    else if ((uncomp_size) && (!read_callback))
+    {
+        /* Reserved, the CRC in the data descriptor and the central directory is set later */
+        cur_archive_file_ofs += uncomp_size;
+        comp_size = uncomp_size;
+    }
+    else if (uncomp_size)
     {
         mz_uint64 uncomp_remaining = uncomp_size;
-        void *pRead_buf = pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, MZ_ZIP_MAX_IO_BUF_SIZE);
+        void *pRead_buf = mz_zip_writer_get_io_buf(pZip);
         if (!pRead_buf)
         {
             return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
@@ -6601,14 +8442,23 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
 
         if (!level)
         {
+#ifdef MINIZ_USE_COPY_FILE_RANGE
+            int copied = -1;
+            if ((read_callback == mz_file_read_func_stdio) && (pZip->m_pWrite == mz_zip_file_write_func) && (uncomp_size > MZ_ZIP_MAX_IO_BUF_SIZE))
+                copied = mz_zip_writer_copy_file_range(pZip, (MZ_FILE *)callback_opaque, cur_archive_file_ofs, uncomp_size, &uncomp_crc32);
+            if (!copied)
+                return MZ_FALSE;
+            if (copied > 0)
+            {
+                cur_archive_file_ofs += uncomp_size;
+                uncomp_remaining = 0;
+            }
+#endif
             while (uncomp_remaining)
             {
                 mz_uint n = (mz_uint)MZ_MIN((mz_uint64)MZ_ZIP_MAX_IO_BUF_SIZE, uncomp_remaining);
                 if ((read_callback(callback_opaque, file_ofs, pRead_buf, n) != n) || (pZip->m_pWrite(pZip->m_pIO_opaque, cur_archive_file_ofs, pRead_buf, n) != n))
-                {
-                    pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
                     return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
-                }
                 file_ofs += n;
                 uncomp_crc32 = (mz_uint32)mz_crc32(uncomp_crc32, (const mz_uint8 *)pRead_buf, n);
                 uncomp_remaining -= n;
@@ -6620,23 +8470,16 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
         {
             mz_bool result = MZ_FALSE;
             mz_zip_writer_add_state state;
-            tdefl_compressor *pComp = (tdefl_compressor *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tdefl_compressor));
+            tdefl_compressor *pComp = mz_zip_writer_get_compressor(pZip);
             if (!pComp)
-            {
-                pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
                 return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
-            }
 
             state.m_pZip = pZip;
             state.m_cur_archive_file_ofs = cur_archive_file_ofs;
             state.m_comp_size = 0;
 
             if (tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
-            {
-                pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
-                pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
                 return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
-            }
 
             for (;;)
             {
@@ -6670,19 +8513,12 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
                 }
             }
 
-            pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
-
             if (!result)
-            {
-                pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
                 return MZ_FALSE;
-            }
 
             comp_size = state.m_comp_size;
             cur_archive_file_ofs = state.m_cur_archive_file_ofs;
         }
-
-        pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
     }
 
     {
@@ -6729,6 +8565,82 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     return MZ_TRUE;
 }
 
+mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pArchive_name, mz_file_read_func read_callback, void* callback_opaque, mz_uint64 size_to_add, const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags,
+                                const char *user_extra_data, mz_uint user_extra_data_len, const char *user_extra_data_central, mz_uint user_extra_data_central_len)
+{
+    return mz_zip_writer_add_callback_internal(pZip, pArchive_name, read_callback, NULL, callback_opaque, size_to_add, pFile_time, pComment, comment_size, level_and_flags,
+        user_extra_data, user_extra_data_len, user_extra_data_central, user_extra_data_central_len, NULL);
+}
+
+mz_bool mz_zip_writer_add_deflate_callback(mz_zip_archive *pZip, const char *pArchive_name, mz_zip_deflate_func deflate_callback, void* callback_opaque, mz_uint64 size_to_add, const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags,
+                                const char *user_extra_data, mz_uint user_extra_data_len, const char *user_extra_data_central, mz_uint user_extra_data_central_len)
+{
+    if (!deflate_callback)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    return mz_zip_writer_add_callback_internal(pZip, pArchive_name, NULL, deflate_callback, callback_opaque, size_to_add, pFile_time, pComment, comment_size, level_and_flags,
+        user_extra_data, user_extra_data_len, user_extra_data_central, user_extra_data_central_len, NULL);
+}
+
+mz_bool mz_zip_writer_add_reserved_file(mz_zip_archive *pZip, const char *pArchive_name, mz_uint64 size, const MZ_TIME_T *pFile_time, mz_uint64 *pData_ofs)
+{
+    if (!pData_ofs)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    return mz_zip_writer_add_callback_internal(pZip, pArchive_name, NULL, NULL, NULL, size, pFile_time, NULL, 0, MZ_NO_COMPRESSION, NULL, 0, NULL, 0, pData_ofs);
+}
+
+mz_bool mz_zip_writer_set_reserved_file_crc32(mz_zip_archive *pZip, mz_uint file_index, mz_uint32 crc32)
+{
+    mz_zip_archive_entry_view view;
+    mz_uint8 *pCentral_dir_header;
+    mz_uint8 crc32_le[sizeof(mz_uint32)];
+    mz_uint64 data_ofs;
+
+    if ((!pZip) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || (!mz_zip_reader_entry_view(pZip, file_index, &view)) ||
+        (view.m_method != 0) || (!(view.m_bit_flag & MZ_ZIP_LDH_BIT_FLAG_HAS_LOCATOR)))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    pCentral_dir_header = (mz_uint8 *)mz_zip_get_cdh(pZip, file_index);
+
+    /* The local header has the same (zip64) extra field as the central directory record, plus the alignment padding if any, */
+    /* then come the data and the data descriptor (signature first) */
+    data_ofs = view.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + view.m_filename_size + MZ_READ_LE16(pCentral_dir_header + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+    if (view.m_comp_size)
+        data_ofs += mz_zip_writer_compute_data_alignment_field_size(pZip, data_ofs);
+
+    MZ_WRITE_LE32(crc32_le, crc32);
+    if (pZip->m_pWrite(pZip->m_pIO_opaque, data_ofs + view.m_comp_size + sizeof(mz_uint32), crc32_le, sizeof(crc32_le)) != sizeof(crc32_le))
+        return mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+
+    MZ_WRITE_LE32(pCentral_dir_header + MZ_ZIP_CDH_CRC32_OFS, crc32);
+
+    return MZ_TRUE;
+}
+
+mz_bool mz_zip_writer_discard_files(mz_zip_archive *pZip, mz_uint file_index)
+{
+    mz_zip_archive_entry_view view;
+    mz_zip_internal_state *pState;
+
+    if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    if (file_index >= pZip->m_total_files)
+        return MZ_TRUE;
+
+    if (!mz_zip_reader_entry_view(pZip, file_index, &view))
+        return MZ_FALSE;
+
+    pState = pZip->m_pState;
+    mz_zip_array_resize(pZip, &pState->m_central_dir, MZ_ZIP_ARRAY_ELEMENT(&pState->m_central_dir_offsets, mz_uint32, file_index), MZ_FALSE);
+    mz_zip_array_resize(pZip, &pState->m_central_dir_offsets, file_index, MZ_FALSE);
+    pZip->m_total_files = file_index;
+    pZip->m_archive_size = view.m_local_header_ofs;
+
+    return MZ_TRUE;
+}
+
 #ifndef MINIZ_NO_STDIO
 
 static size_t mz_file_read_func_stdio(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n)
@@ -7024,7 +8936,7 @@ mz_bool mz_zip_writer_add_from_zip_reader(mz_zip_archive *pZip, mz_zip_archive *
     cur_dst_file_ofs += num_alignment_padding_bytes;
 
     local_dir_header_ofs = cur_dst_file_ofs;
-    if (pZip->m_file_offset_alignment)
+    if ((pZip->m_file_offset_alignment) && (!(pZip->m_pState->m_init_flags & MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA)))
     {
         MZ_ASSERT((local_dir_header_ofs & (pZip->m_file_offset_alignment - 1)) == 0);
     }
@@ -7691,6 +9603,197 @@ mz_bool mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip
     return mz_zip_file_stat_internal(pZip, file_index, mz_zip_get_cdh(pZip, file_index), pStat, NULL);
 }
 
+mz_bool mz_zip_reader_entry_view(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_entry_view *pView)
+{
+    const mz_uint8 *p = mz_zip_get_cdh(pZip, file_index);
+
+    if ((!p) || (!pView))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    pView->m_file_index = file_index;
+    pView->m_bit_flag = MZ_READ_LE16(p + MZ_ZIP_CDH_BIT_FLAG_OFS);
+    pView->m_method = MZ_READ_LE16(p + MZ_ZIP_CDH_METHOD_OFS);
+    pView->m_crc32 = MZ_READ_LE32(p + MZ_ZIP_CDH_CRC32_OFS);
+    pView->m_comp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_COMPRESSED_SIZE_OFS);
+    pView->m_uncomp_size = MZ_READ_LE32(p + MZ_ZIP_CDH_DECOMPRESSED_SIZE_OFS);
+    pView->m_local_header_ofs = MZ_READ_LE32(p + MZ_ZIP_CDH_LOCAL_HEADER_OFS);
+    pView->m_pFilename = (const char *)p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE;
+    pView->m_filename_size = MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+    pView->m_is_directory = mz_zip_reader_is_file_a_directory(pZip, file_index);
+    pView->m_is_supported = mz_zip_reader_is_file_supported(pZip, file_index);
+
+    if (MZ_MAX(MZ_MAX(pView->m_comp_size, pView->m_uncomp_size), pView->m_local_header_ofs) == MZ_UINT32_MAX)
+        return mz_zip_read_zip64_extra_data(pZip, p, &pView->m_comp_size, &pView->m_uncomp_size, &pView->m_local_header_ofs, NULL);
+
+    return MZ_TRUE;
+}
+
+mz_bool mz_zip_reader_get_stored_file_data(mz_zip_archive *pZip, mz_uint file_index, const void **ppData, size_t *pSize)
+{
+    mz_zip_archive_entry_view view;
+    const mz_uint8 *pLocal_header;
+    mz_uint64 data_ofs;
+
+    if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING) || (!ppData) || (!pSize))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    if (!mz_zip_reader_entry_view(pZip, file_index, &view))
+        return MZ_FALSE;
+
+    if ((view.m_is_directory) || (view.m_method) || (view.m_comp_size != view.m_uncomp_size) ||
+        (view.m_bit_flag & (MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_IS_ENCRYPTED | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_USES_STRONG_ENCRYPTION)))
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_METHOD);
+
+    /* Archives read through stdio have no data in place to point at */
+    if (!pZip->m_pState->m_pMem)
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_FEATURE);
+
+    if (view.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE > pZip->m_archive_size)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    pLocal_header = (const mz_uint8 *)pZip->m_pState->m_pMem + view.m_local_header_ofs;
+    if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    data_ofs = view.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+    if (data_ofs + view.m_comp_size > pZip->m_archive_size)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    *ppData = (const mz_uint8 *)pZip->m_pState->m_pMem + data_ofs;
+    *pSize = (size_t)view.m_comp_size;
+
+    return MZ_TRUE;
+}
+
+mz_bool mz_zip_reader_get_extra_field(mz_zip_archive *pZip, mz_uint file_index, mz_uint16 header_id, const void **ppData, mz_uint16 *pSize)
+{
+    const mz_uint8 *p = mz_zip_get_cdh(pZip, file_index), *pExtra;
+    mz_uint32 extra_size_remaining;
+
+    if ((!p) || (!ppData) || (!pSize))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    pExtra = p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+    extra_size_remaining = MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+
+    while (extra_size_remaining >= sizeof(mz_uint16) * 2)
+    {
+        mz_uint32 field_id = MZ_READ_LE16(pExtra);
+        mz_uint32 field_data_size = MZ_READ_LE16(pExtra + sizeof(mz_uint16));
+        mz_uint32 field_total_size = field_data_size + sizeof(mz_uint16) * 2;
+
+        if (field_total_size > extra_size_remaining)
+            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+        if (field_id == header_id)
+        {
+            *ppData = pExtra + sizeof(mz_uint16) * 2;
+            *pSize = (mz_uint16)field_data_size;
+            return MZ_TRUE;
+        }
+
+        pExtra += field_total_size;
+        extra_size_remaining -= field_total_size;
+    }
+
+    return mz_zip_set_error(pZip, MZ_ZIP_FILE_NOT_FOUND);
+}
+
+mz_bool mz_zip_reader_extract_part_to_mem(mz_zip_archive *pZip, mz_uint file_index, mz_uint64 comp_ofs, mz_uint64 comp_size, void *pBuf, size_t buf_size, mz_uint32 *pCrc32)
+{
+    mz_zip_archive_entry_view view;
+    mz_uint32 local_header_u32[(MZ_ZIP_LOCAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
+    mz_uint8 *pLocal_header = (mz_uint8 *)local_header_u32;
+    mz_uint8 *pRead_buf = NULL;
+    mz_uint64 data_ofs, in_ofs = 0;
+    size_t out_ofs = 0;
+    mz_bool last_part, status = MZ_TRUE;
+    tinfl_decompressor *pInflator;
+    tinfl_status inflate_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+
+    if ((!pZip) || (!pZip->m_pState) || (!pZip->m_pRead) || (pZip->m_zip_mode != MZ_ZIP_MODE_READING) || ((!pBuf) && (buf_size)))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    if (!mz_zip_reader_entry_view(pZip, file_index, &view))
+        return MZ_FALSE;
+
+    if (view.m_bit_flag & (MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_IS_ENCRYPTED | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_USES_STRONG_ENCRYPTION | MZ_ZIP_GENERAL_PURPOSE_BIT_FLAG_COMPRESSED_PATCH_FLAG))
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_ENCRYPTION);
+
+    if (view.m_method != MZ_DEFLATED)
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_METHOD);
+
+    if ((!comp_size) || (comp_ofs > view.m_comp_size) || (comp_size > view.m_comp_size - comp_ofs) || (buf_size > view.m_uncomp_size))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    /* The last part ends the stream with a final block, the others with a flush */
+    last_part = (comp_ofs + comp_size == view.m_comp_size);
+
+    if (pZip->m_pRead(pZip->m_pIO_opaque, view.m_local_header_ofs, pLocal_header, MZ_ZIP_LOCAL_DIR_HEADER_SIZE) != MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
+        return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+
+    if (MZ_READ_LE32(pLocal_header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    data_ofs = view.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(pLocal_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+    if ((data_ofs + view.m_comp_size) > pZip->m_archive_size)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    if (NULL == (pInflator = (tinfl_decompressor *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tinfl_decompressor))))
+        return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+
+    if ((!pZip->m_pState->m_pMem) && (NULL == (pRead_buf = (mz_uint8 *)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, (size_t)MZ_MIN(comp_size, (mz_uint64)MZ_ZIP_MAX_IO_BUF_SIZE)))))
+    {
+        pZip->m_pFree(pZip->m_pAlloc_opaque, pInflator);
+        return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+    }
+
+    tinfl_init(pInflator);
+
+    /* The output buffer isn't wrapped around, so back references before the part fail */
+    while ((inflate_status == TINFL_STATUS_NEEDS_MORE_INPUT) && (in_ofs < comp_size))
+    {
+        const mz_uint8 *pIn;
+        size_t in_size, out_size = buf_size - out_ofs;
+
+        if (pZip->m_pState->m_pMem)
+        {
+            pIn = (const mz_uint8 *)pZip->m_pState->m_pMem + data_ofs + comp_ofs + in_ofs;
+            in_size = (size_t)(comp_size - in_ofs);
+        }
+        else
+        {
+            in_size = (size_t)MZ_MIN(comp_size - in_ofs, (mz_uint64)MZ_ZIP_MAX_IO_BUF_SIZE);
+            if (pZip->m_pRead(pZip->m_pIO_opaque, data_ofs + comp_ofs + in_ofs, pRead_buf, in_size) != in_size)
+            {
+                mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+                status = MZ_FALSE;
+                break;
+            }
+            pIn = pRead_buf;
+        }
+
+        inflate_status = tinfl_decompress(pInflator, pIn, &in_size, (mz_uint8 *)pBuf, (mz_uint8 *)pBuf + out_ofs, &out_size, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF | TINFL_FLAG_HAS_MORE_INPUT);
+        in_ofs += in_size;
+        out_ofs += out_size;
+    }
+
+    if ((status) && ((out_ofs != buf_size) || (inflate_status != (last_part ? TINFL_STATUS_DONE : TINFL_STATUS_NEEDS_MORE_INPUT))))
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_DECOMPRESSION_FAILED);
+        status = MZ_FALSE;
+    }
+
+    if ((status) && (pCrc32))
+        *pCrc32 = (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)pBuf, buf_size);
+
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pInflator);
+    if (pRead_buf)
+        pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
+
+    return status;
+}
+
 mz_bool mz_zip_end(mz_zip_archive *pZip)
 {
     if (!pZip)
@@ -208,6 +208,9 @@ mz_ulong mz_adler32(mz_ulong adler, const unsigned char *ptr, size_t buf_len);
 /* mz_crc32() returns the initial CRC-32 value to use when called with ptr==NULL. */
 mz_ulong mz_crc32(mz_ulong crc, const unsigned char *ptr, size_t buf_len);
 
+/* mz_crc32_combine() returns the CRC-32 of two concatenated buffers, given the CRC-32 of each buffer and the length of the second one (like zlib's crc32_combine()). */
+mz_ulong mz_crc32_combine(mz_ulong crc1, mz_ulong crc2, size_t len2);
+
 /* Compression strategies. */
 enum
 {
@@ -729,6 +732,10 @@ typedef struct
 /* flags: See the above enums (TDEFL_HUFFMAN_ONLY, TDEFL_WRITE_ZLIB_HEADER, etc.) */
 tdefl_status tdefl_init(tdefl_compressor *d, tdefl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, int flags);
 
+/* Primes the dictionary with data that precedes the input (like zlib's deflateSetDictionary(), but for raw deflate streams as well), so the first matches can refer back into it. */
+/* Must be called right after tdefl_init(). Only the last TDEFL_LZ_DICT_SIZE bytes of pDict are used. */
+tdefl_status tdefl_set_dictionary(tdefl_compressor *d, const void *pDict, size_t dict_size);
+
 /* Compresses a block of data, consuming as much of the specified input buffer as possible, and writing as much compressed data to the specified output buffer as possible. */
 tdefl_status tdefl_compress(tdefl_compressor *d, const void *pIn_buf, size_t *pIn_buf_size, void *pOut_buf, size_t *pOut_buf_size, tdefl_flush flush);
 
@@ -768,12 +775,14 @@ extern "C" {
 /* TINFL_FLAG_HAS_MORE_INPUT: If set, there are more input bytes available beyond the end of the supplied input buffer. If clear, the input buffer contains all remaining input. */
 /* TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF: If set, the output buffer is large enough to hold the entire decompressed stream. If clear, the output buffer is at least the size of the dictionary (typically 32KB). */
 /* TINFL_FLAG_COMPUTE_ADLER32: Force adler-32 checksum computation of the decompressed bytes. */
+/* TINFL_FLAG_STOP_AT_BLOCK_START: Return TINFL_STATUS_BLOCK_START before each deflate block but the first, where decompression can be resumed later (see tinfl_init_at_block_start()). */
 enum
 {
     TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
     TINFL_FLAG_HAS_MORE_INPUT = 2,
     TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
-    TINFL_FLAG_COMPUTE_ADLER32 = 8
+    TINFL_FLAG_COMPUTE_ADLER32 = 8,
+    TINFL_FLAG_STOP_AT_BLOCK_START = 16
 };
 
 /* High level decompression functions: */
@@ -841,7 +850,11 @@ typedef enum {
     /* Note if the source compressed data was corrupted it's possible for the inflator to return a lot of uncompressed data to the caller. I've been assuming you know how much uncompressed data to expect */
     /* (either exact or worst case) and will stop calling the inflator and fail after receiving too much. In pure streaming scenarios where you have no idea how many bytes to expect this may not be possible */
     /* so I may need to add some code to address this. */
-    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+
+    /* With TINFL_FLAG_STOP_AT_BLOCK_START, this flag indicates the inflator is at the start of a deflate block: all the input before the last */
+    /* m_num_bits bits consumed so far belongs to the previous blocks. Call it again to go on. */
+    TINFL_STATUS_BLOCK_START = 3
 } tinfl_status;
 
 /* Initializes the decompressor to its initial state. */
@@ -853,6 +866,11 @@ typedef enum {
     MZ_MACRO_END
 #define tinfl_get_adler32(r) (r)->m_check_adler32
 
+/* Initializes the decompressor to resume a raw deflate stream at the start of a block (see TINFL_STATUS_BLOCK_START), the next input byte being the */
+/* one after the block's first bit. num_bits (0-7) is the number of bits of the byte before it that belong to the block, bit_buf those bits (its low bits). */
+/* Without TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF, the output buffer must already hold the last TINFL_LZ_DICT_SIZE bytes of output before the block. */
+void tinfl_init_at_block_start(tinfl_decompressor *r, mz_uint32 bit_buf, mz_uint num_bits);
+
 /* Main low-level decompressor coroutine function. This is the only function actually needed for decompression. All the other functions are just high-level helpers for improved usability. */
 /* This is a universal API, i.e. it can be used as a building block to build any desired higher level decompression API. In the limit case, it can be called once per every byte input or output. */
 tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags);
@@ -976,6 +994,29 @@ typedef struct
 
 } mz_zip_archive_file_stat;
 
+/* A compact description of an archive file entry, read straight from its central directory record. */
+typedef struct
+{
+    /* Central directory file index. */
+    mz_uint32 m_file_index;
+
+    mz_uint16 m_bit_flag;
+    mz_uint16 m_method;
+    mz_uint32 m_crc32;
+
+    /* Sizes and local header offset, with the zip64 extended information already applied. */
+    mz_uint64 m_comp_size;
+    mz_uint64 m_uncomp_size;
+    mz_uint64 m_local_header_ofs;
+
+    /* Filename, pointing into the archive's central directory. NOT zero terminated, and only valid while the archive is open. */
+    const char *m_pFilename;
+    mz_uint16 m_filename_size;
+
+    mz_bool m_is_directory;
+    mz_bool m_is_supported;
+} mz_zip_archive_entry_view;
+
 typedef size_t (*mz_file_read_func)(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n);
 typedef size_t (*mz_file_write_func)(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n);
 typedef mz_bool (*mz_file_needs_keepalive)(void *pOpaque);
@@ -999,7 +1040,8 @@ typedef enum {
     MZ_ZIP_FLAG_VALIDATE_HEADERS_ONLY = 0x2000,     /* validate the local headers, but don't decompress the entire file and check the crc32 */
     MZ_ZIP_FLAG_WRITE_ZIP64 = 0x4000,               /* always use the zip64 file format, instead of the original zip file format with automatic switch to zip64. Use as flags parameter with mz_zip_writer_init*_v2 */
     MZ_ZIP_FLAG_WRITE_ALLOW_READING = 0x8000,
-    MZ_ZIP_FLAG_ASCII_FILENAME = 0x10000
+    MZ_ZIP_FLAG_ASCII_FILENAME = 0x10000,
+    MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA = 0x20000   /* with m_file_offset_alignment set (up to 32KB), align the data of stored files instead of every local header, zipalign style. Use as flags parameter with mz_zip_writer_init*_v2 */
 } mz_zip_flags;
 
 typedef enum {
@@ -1169,6 +1211,23 @@ int mz_zip_reader_locate_file_v2(mz_zip_archive *pZip, const char *pName, const
 /* Returns detailed information about an archive file entry. */
 mz_bool mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat);
 
+/* Like mz_zip_reader_file_stat(), but cheaper: doesn't copy the filename and the comment, nor converts the file time. */
+mz_bool mz_zip_reader_entry_view(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_entry_view *pView);
+
+/* Points *ppData at the data of a stored (uncompressed, unencrypted) file in place, without copying it. Only archives read from memory or memory mapped have it there. */
+/* The data stays valid until the archive is closed. Its CRC isn't checked, use mz_zip_validate_file() for that. */
+mz_bool mz_zip_reader_get_stored_file_data(mz_zip_archive *pZip, mz_uint file_index, const void **ppData, size_t *pSize);
+
+/* Points *ppData at the data (past its header ID and size) of the extra field with the given header ID in the central directory record of a file, in place. */
+/* The data stays valid until the archive is closed. Fails with MZ_ZIP_FILE_NOT_FOUND if the record has no such field. */
+mz_bool mz_zip_reader_get_extra_field(mz_zip_archive *pZip, mz_uint file_index, mz_uint16 header_id, const void **ppData, mz_uint16 *pSize);
+
+/* Decompresses a part of a deflated file on its own: the comp_size bytes from comp_ofs within its compressed data, which must start a deflate block on a byte boundary, */
+/* never refer back before it, and end either the whole stream or with a flush (see TDEFL_SYNC_FLUSH), i.e. a part compressed separately by a fresh compressor. */
+/* Its output must be exactly buf_size bytes long, and its CRC-32 is returned in *pCrc32 (if not NULL) to be combined with the other parts' (see mz_crc32_combine()). */
+/* Parts of the same file can be decompressed at the same time, from several threads. */
+mz_bool mz_zip_reader_extract_part_to_mem(mz_zip_archive *pZip, mz_uint file_index, mz_uint64 comp_ofs, mz_uint64 comp_size, void *pBuf, size_t buf_size, mz_uint32 *pCrc32);
+
 /* MZ_TRUE if the file is in zip64 format. */
 /* A file is considered zip64 if it contained a zip64 end of central directory marker, or if it contained any zip64 extended file information fields in the central directory. */
 mz_bool mz_zip_is_zip64(mz_zip_archive *pZip);
@@ -1202,6 +1261,24 @@ mz_zip_reader_extract_iter_state* mz_zip_reader_extract_file_iter_new(mz_zip_arc
 size_t mz_zip_reader_extract_iter_read(mz_zip_reader_extract_iter_state* pState, void* pvBuf, size_t buf_size);
 mz_bool mz_zip_reader_extract_iter_free(mz_zip_reader_extract_iter_state* pState);
 
+/* Random access reads within a (stored or deflated) file. Deflated files are inflated from the closest checkpoint before the offset read: */
+/* the position of a deflate block start and the last TINFL_LZ_DICT_SIZE bytes of output before it, recorded at the first block start */
+/* checkpoint_interval bytes (0 for 4MB) or more past the previous checkpoint the first time inflating gets there. So a read costs about */
+/* checkpoint_interval bytes of inflating (plus up to a block), plus the reads before it. */
+/* Reads aren't CRC checked. A state is used by one thread at a time. */
+struct mz_zip_reader_seek_state_tag;
+typedef struct mz_zip_reader_seek_state_tag mz_zip_reader_seek_state;
+
+mz_zip_reader_seek_state *mz_zip_reader_seek_new(mz_zip_archive *pZip, mz_uint file_index, mz_uint64 checkpoint_interval);
+size_t mz_zip_reader_seek_read(mz_zip_reader_seek_state *pState, mz_uint64 file_ofs, void *pBuf, size_t buf_size);
+mz_bool mz_zip_reader_seek_free(mz_zip_reader_seek_state *pState);
+
+/* Saves the checkpoints recorded so far (read the end of the file first to have them all), to skip recording them next time. Returns their size, */
+/* they're only written if buf_size is big enough. Loading checks their CRC-32 and that they match the file; the inflator is rebuilt from each */
+/* checkpoint's position, so damaged or forged checkpoints can only make reads fail or return wrong data. */
+size_t mz_zip_reader_seek_save_checkpoints(mz_zip_reader_seek_state *pState, void *pBuf, size_t buf_size);
+mz_bool mz_zip_reader_seek_load_checkpoints(mz_zip_reader_seek_state *pState, const void *pBuf, size_t buf_size);
+
 #ifndef MINIZ_NO_STDIO
 /* Extracts a archive file to a disk file and sets its last accessed and modified times. */
 /* This function only extracts files, not archive directory records. */
@@ -1251,6 +1328,9 @@ mz_bool mz_zip_writer_init_v2(mz_zip_archive *pZip, mz_uint64 existing_size, mz_
 mz_bool mz_zip_writer_init_heap(mz_zip_archive *pZip, size_t size_to_reserve_at_beginning, size_t initial_allocation_size);
 mz_bool mz_zip_writer_init_heap_v2(mz_zip_archive *pZip, size_t size_to_reserve_at_beginning, size_t initial_allocation_size, mz_uint flags);
 
+/* Reserves room in the central directory for num_files more files whose names total total_filename_size bytes, so it doesn't have to grow while they are added. */
+mz_bool mz_zip_writer_reserve_central_dir(mz_zip_archive *pZip, mz_uint num_files, mz_uint64 total_filename_size);
+
 #ifndef MINIZ_NO_STDIO
 mz_bool mz_zip_writer_init_file(mz_zip_archive *pZip, const char *pFilename, mz_uint64 size_to_reserve_at_beginning);
 mz_bool mz_zip_writer_init_file_v2(mz_zip_archive *pZip, const char *pFilename, mz_uint64 size_to_reserve_at_beginning, mz_uint flags);
@@ -1286,6 +1366,24 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
     const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags, const char *user_extra_data_local, mz_uint user_extra_data_local_len,
     const char *user_extra_data_central, mz_uint user_extra_data_central_len);
 
+/* Like mz_zip_writer_add_read_buf_callback(), except the entry's data is supplied already deflated (raw, without a zlib header) by a callback, so it can be compressed by other means (e.g. in blocks on several threads, see tdefl_set_dictionary()). */
+/* The callback must push the whole deflate stream of size_to_add uncompressed bytes through pPut_buf_func and return the CRC-32 of the uncompressed data in pUncomp_crc32. The level must not be 0. */
+/* user_extra_data_central is only read once the callback has returned, so the callback may fill it in (e.g. with an index of the blocks it deflated), its length must be known beforehand though. */
+typedef mz_bool (*mz_zip_deflate_func)(void *pOpaque, tdefl_put_buf_func_ptr pPut_buf_func, void *pPut_buf_user, mz_uint32 *pUncomp_crc32);
+
+mz_bool mz_zip_writer_add_deflate_callback(mz_zip_archive *pZip, const char *pArchive_name, mz_zip_deflate_func deflate_callback, void* callback_opaque, mz_uint64 size_to_add,
+    const MZ_TIME_T *pFile_time, const void *pComment, mz_uint16 comment_size, mz_uint level_and_flags, const char *user_extra_data_local, mz_uint user_extra_data_local_len,
+    const char *user_extra_data_central, mz_uint user_extra_data_central_len);
+
+/* Adds a stored file of size bytes whose data is left for the caller to write, at *pData_ofs from the start of the archive, so the data of many files can be written at once (e.g. from several threads, through their own handles of the archive file). */
+/* Its CRC-32 must then be set with mz_zip_writer_set_reserved_file_crc32() (file index m_total_files - 1 after this call) before the archive is finalized. */
+mz_bool mz_zip_writer_add_reserved_file(mz_zip_archive *pZip, const char *pArchive_name, mz_uint64 size, const MZ_TIME_T *pFile_time, mz_uint64 *pData_ofs);
+mz_bool mz_zip_writer_set_reserved_file_crc32(mz_zip_archive *pZip, mz_uint file_index, mz_uint32 crc32);
+
+/* Drops the file at file_index and all the files added after it, from the central directory and the end of the archive (e.g. reserved files whose data couldn't be written). */
+/* The archive file isn't truncated, finalizing writes the central directory over the dropped data but anything past it is left. */
+mz_bool mz_zip_writer_discard_files(mz_zip_archive *pZip, mz_uint file_index);
+
 #ifndef MINIZ_NO_STDIO
 /* Adds the contents of a disk file to an archive. This function also records the disk file's modified time into the archive. */
 /* level_and_flags - compression level (0-10, see MZ_BEST_SPEED, MZ_BEST_COMPRESSION, etc.) logically OR'd with zero or more mz_zip_flags, or just set to MZ_DEFAULT_COMPRESSION. */
@@ -17,15 +17,6 @@
     future->reportResult(result);                                            \
     future->setProgressValue(progress);                                      \
 
-#define REPORT_RESULT_UNSAFE(result)                                         \
-    if (future->isProgressUpdateNeeded()) {                                  \
-        if (future->isPaused())                                              \
-            future->waitForResume();                                         \
-        if (future->isCanceled())                                            \
-            return 0;                                                        \
-        future->reportResult(result);                                        \
-    }
-
 #define REPORT_PROGRESS_SAFE(progress, zip)                                  \
     if (future->isProgressUpdateNeeded()) {                                  \
         if (future->isPaused())                                              \
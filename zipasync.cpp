@@ -25,15 +25,1536 @@
 #include "report.h"
 #include <async.h>
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <limits>
 
 #include <QFileInfo>
 #include <QTemporaryDir>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QWaitCondition>
+#include <QMutex>
+#include <QHash>
+#include <QThread>
+#include <QThreadStorage>
+#include <QDateTime>
+#include <QSet>
+#include <QBuffer>
+#include <QtEndian>
+
+#if defined(Q_OS_UNIX)
+#  include <dirent.h>
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  if defined(DT_UNKNOWN) && defined(AT_SYMLINK_NOFOLLOW)
+#    define ZIPASYNC_NATIVE_SCANNER
+#  endif
+#endif
 
 namespace ZipAsync {
 
 namespace Internal {
 
-enum { INITIAL_NUMBER_OF_ENTRIES = 40960 };
+enum {
+    MAX_RESOLVED_AHEAD_ENTRIES = 40960,
+    MAX_PENDING_ENTRIES_PER_THREAD = 4,
+    MAX_PENDING_BYTES = 64 * 1024 * 1024,
+    MAX_IN_MEMORY_ENTRY_SIZE = 8 * 1024 * 1024,
+    DEFLATE_BLOCK_SIZE = 1024 * 1024,
+    STORE_BUFFER_SIZE = 1024 * 1024,
+    MIN_POOLED_STORE_SIZE = 1024 * 1024,
+    STORED_DATA_ALIGNMENT = 4096,
+    MAX_INDEXED_BLOCKS = 8192,
+    MAX_INDEXED_BLOCK_SIZE = 64 * 1024 * 1024,
+    BLOCK_INDEX_FIELD_ID = 0x425A,
+    BLOCK_INDEX_HEADER_SIZE = 8
+};
+
+template <typename Function>
+class Task final : public QRunnable
+{
+public:
+    explicit Task(Function&& function) : m_function(std::move(function)) {}
+    void run() override { m_function(); }
+
+private:
+    Function m_function;
+};
+
+template <typename Function>
+void startTask(QThreadPool* pool, Function&& function)
+{
+    pool->start(new Task<typename std::decay<Function>::type>(std::forward<Function>(function)));
+}
+
+/*
+    Per operation allocator for miniz (m_pAlloc, m_pFree and m_pRealloc of an archive), so the
+    allocations of a job don't contend on the global heap with other jobs. Small blocks are carved
+    out of big chunks and recycled through free lists (one per power of two size class), big ones
+    are left to the heap. Chunks are all released at once when the arena is destroyed, so it must
+    outlive the archive it is installed into. It is thread safe, since the archive may be shared.
+*/
+class Arena final
+{
+    Q_DISABLE_COPY(Arena)
+
+public:
+    Arena()
+        : m_chunkPosition(nullptr)
+        , m_chunkEnd(nullptr)
+    {
+        std::fill(m_freeLists, m_freeLists + CLASS_COUNT, nullptr);
+    }
+
+    ~Arena()
+    {
+        for (char* chunk : m_chunks)
+            ::free(chunk);
+    }
+
+    // Must be called before initializing the archive
+    void install(mz_zip_archive* zip)
+    {
+        zip->m_pAlloc = allocate;
+        zip->m_pFree = release;
+        zip->m_pRealloc = reallocate;
+        zip->m_pAlloc_opaque = this;
+    }
+
+private:
+    enum {
+        HEADER_SIZE = 16, // Keeps blocks aligned for any type
+        MIN_CLASS = 4,
+        MAX_CLASS = 17,
+        CLASS_COUNT = MAX_CLASS + 1,
+        HEAP_CLASS = CLASS_COUNT,
+        CHUNK_SIZE = 1024 * 1024
+    };
+
+    // Size class (or HEAP_CLASS) is kept in front of each block
+    static size_t& blockClass(void* block) { return *reinterpret_cast<size_t*>(static_cast<char*>(block) - HEADER_SIZE); }
+
+    static size_t sizeClass(size_t size)
+    {
+        size_t sizeClass = MIN_CLASS;
+        while (sizeClass < HEAP_CLASS && (size_t(1) << sizeClass) < size)
+            ++sizeClass;
+        return sizeClass;
+    }
+
+    void* allocate(size_t size)
+    {
+        const size_t sizeClass = Arena::sizeClass(size);
+        if (sizeClass == HEAP_CLASS) {
+            char* block = static_cast<char*>(::malloc(HEADER_SIZE + size));
+            if (!block)
+                return nullptr;
+            *reinterpret_cast<size_t*>(block) = HEAP_CLASS;
+            return block + HEADER_SIZE;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        if (void* block = m_freeLists[sizeClass]) {
+            m_freeLists[sizeClass] = *static_cast<void**>(block);
+            return block;
+        }
+
+        const size_t blockSize = HEADER_SIZE + (size_t(1) << sizeClass);
+        if (size_t(m_chunkEnd - m_chunkPosition) < blockSize) {
+            char* chunk = static_cast<char*>(::malloc(CHUNK_SIZE));
+            if (!chunk)
+                return nullptr;
+            m_chunks.push_back(chunk);
+            m_chunkPosition = chunk;
+            m_chunkEnd = chunk + CHUNK_SIZE;
+        }
+        char* block = m_chunkPosition + HEADER_SIZE;
+        m_chunkPosition += blockSize;
+        blockClass(block) = sizeClass;
+        return block;
+    }
+
+    void release(void* block)
+    {
+        if (!block)
+            return;
+        const size_t sizeClass = blockClass(block);
+        if (sizeClass == HEAP_CLASS) {
+            ::free(static_cast<char*>(block) - HEADER_SIZE);
+            return;
+        }
+        QMutexLocker locker(&m_mutex);
+        *static_cast<void**>(block) = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = block;
+    }
+
+    void* reallocate(void* block, size_t size)
+    {
+        if (!block)
+            return allocate(size);
+
+        const size_t sizeClass = blockClass(block);
+        if (sizeClass == HEAP_CLASS) {
+            if (Arena::sizeClass(size) == HEAP_CLASS) {
+                char* newBlock = static_cast<char*>(::realloc(static_cast<char*>(block) - HEADER_SIZE,
+                                                              HEADER_SIZE + size));
+                return newBlock ? newBlock + HEADER_SIZE : nullptr;
+            }
+        } else if (size <= (size_t(1) << sizeClass)) {
+            return block;
+        }
+
+        void* newBlock = allocate(size);
+        if (!newBlock)
+            return nullptr;
+        const size_t oldSize = sizeClass == HEAP_CLASS ? size : qMin(size, size_t(1) << sizeClass);
+        memcpy(newBlock, block, oldSize);
+        release(block);
+        return newBlock;
+    }
+
+    static void* allocate(void* opaque, size_t items, size_t size)
+    {
+        if (size && items > size_t(-1) / size)
+            return nullptr;
+        return static_cast<Arena*>(opaque)->allocate(items * size);
+    }
+
+    static void release(void* opaque, void* address)
+    {
+        static_cast<Arena*>(opaque)->release(address);
+    }
+
+    static void* reallocate(void* opaque, void* address, size_t items, size_t size)
+    {
+        if (size && items > size_t(-1) / size)
+            return nullptr;
+        return static_cast<Arena*>(opaque)->reallocate(address, items * size);
+    }
+
+    void* m_freeLists[CLASS_COUNT];
+    std::vector<char*> m_chunks;
+    char* m_chunkPosition;
+    char* m_chunkEnd;
+    QMutex m_mutex;
+};
+
+struct CompressedEntry
+{
+    QByteArray data;
+    mz_uint64 uncompressedSize = 0;
+    mz_uint32 crc32 = MZ_CRC32_INIT;
+    MZ_TIME_T lastModified = 0;
+    bool deflated = false;
+    bool failed = false;
+};
+
+mz_bool appendToByteArray(const void* buffer, int length, void* userData)
+{
+    static_cast<QByteArray*>(userData)->append(static_cast<const char*>(buffer), length);
+    return MZ_TRUE;
+}
+
+// Compressor and input buffer of a worker thread, reused across jobs instead of reallocated
+struct WorkerContext
+{
+    WorkerContext() : compressor(tdefl_compressor_alloc()) {}
+    ~WorkerContext() { tdefl_compressor_free(compressor); }
+
+    tdefl_compressor* compressor;
+    QByteArray input;
+};
+
+WorkerContext* workerContext()
+{
+    static QThreadStorage<WorkerContext*> contexts;
+    if (!contexts.hasLocalData())
+        contexts.setLocalData(new WorkerContext);
+    return contexts.localData();
+}
+
+void compressData(const QByteArray& data, MZ_TIME_T lastModified,
+                  CompressionLevel compressionLevel, CompressedEntry* entry)
+{
+    entry->uncompressedSize = data.size();
+    entry->lastModified = lastModified;
+    entry->crc32 = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8*>(data.constData()), data.size());
+
+    // Same rule as miniz: tiny entries are never worth deflating
+    if (compressionLevel == NoCompression || data.size() <= 3) {
+        entry->data = data;
+        return;
+    }
+
+    tdefl_compressor* compressor = workerContext()->compressor;
+    const int flags = tdefl_create_comp_flags_from_zip_params(compressionLevel, -15, MZ_DEFAULT_STRATEGY);
+    entry->data.reserve(data.size() / 2);
+    if (!compressor
+            || tdefl_init(compressor, appendToByteArray, &entry->data, flags) != TDEFL_STATUS_OKAY
+            || tdefl_compress_buffer(compressor, data.constData(), data.size(), TDEFL_FINISH) != TDEFL_STATUS_DONE) {
+        entry->failed = true;
+        return;
+    }
+    entry->deflated = true;
+}
+
+void compressFile(const QString& filePath, qint64 size, MZ_TIME_T lastModified,
+                  CompressionLevel compressionLevel, CompressedEntry* entry)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        entry->failed = true;
+        return;
+    }
+
+    QByteArray& data = workerContext()->input;
+    data.resize(size);
+    if (file.read(data.data(), size) != size) {
+        entry->failed = true;
+        return;
+    }
+
+    compressData(data, lastModified, compressionLevel, entry);
+    // Entries left uncompressed get a copy of their own, sharing the input buffer would make the
+    // next resize() on this thread allocate a new one
+    if (!entry->deflated)
+        entry->data = QByteArray(data.constData(), data.size());
+}
+
+// Deflates a block of a file, primed with the 32 KiB preceding it (unless it must be decodable on
+// its own), so blocks can be concatenated
+void compressBlock(const QString& filePath, qint64 offset, qint64 length, bool last, bool primed,
+                   CompressionLevel compressionLevel, CompressedEntry* block)
+{
+    QFile file(filePath);
+    const qint64 dictionaryLength = primed ? qMin(offset, qint64(TDEFL_LZ_DICT_SIZE)) : 0;
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset - dictionaryLength)) {
+        block->failed = true;
+        return;
+    }
+
+    WorkerContext* context = workerContext();
+    QByteArray& data = context->input;
+    data.resize(dictionaryLength + length);
+    if (file.read(data.data(), data.size()) != data.size() || !context->compressor) {
+        block->failed = true;
+        return;
+    }
+
+    const auto input = reinterpret_cast<const mz_uint8*>(data.constData());
+    block->uncompressedSize = length;
+    block->crc32 = mz_crc32(MZ_CRC32_INIT, input + dictionaryLength, length);
+
+    // Non-final blocks end with a sync flush, so the next block starts on a byte boundary
+    tdefl_compressor* compressor = context->compressor;
+    const int flags = tdefl_create_comp_flags_from_zip_params(compressionLevel, -15, MZ_DEFAULT_STRATEGY);
+    block->data.reserve(length / 2);
+    const tdefl_status status
+            = tdefl_init(compressor, appendToByteArray, &block->data, flags) != TDEFL_STATUS_OKAY
+            || tdefl_set_dictionary(compressor, input, dictionaryLength) != TDEFL_STATUS_OKAY
+            ? TDEFL_STATUS_BAD_PARAM
+            : tdefl_compress_buffer(compressor, input + dictionaryLength, length,
+                                    last ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+
+    block->failed = status != (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+    block->deflated = true;
+}
+
+bool addCompressedEntry(mz_zip_archive* zip, const char* archivePath,
+                        CompressedEntry* entry, CompressionLevel compressionLevel)
+{
+    if (entry->deflated) {
+        return mz_zip_writer_add_mem_ex_v2(zip, archivePath, entry->data.constData(), entry->data.size(),
+                                           nullptr, 0, compressionLevel | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                                           entry->uncompressedSize, entry->crc32, &entry->lastModified,
+                                           nullptr, 0, nullptr, 0);
+    }
+    return mz_zip_writer_add_mem_ex_v2(zip, archivePath, entry->data.constData(), entry->data.size(),
+                                       nullptr, 0, 0, 0, 0, &entry->lastModified, nullptr, 0, nullptr, 0);
+}
+
+/*
+    Compresses files into memory on a dedicated thread pool, while the thread that owns the
+    zip writer dequeues the results in the same order they were enqueued. Hence the archive
+    layout stays identical to the serial one. The amount of pending work is bounded both by
+    the number of entries and by the total size of the source files being held in memory.
+*/
+class CompressionQueue final
+{
+    Q_DISABLE_COPY(CompressionQueue)
+
+public:
+    CompressionQueue()
+        : m_pendingBytes(0)
+        , m_canceled(false)
+    {
+        m_pool.setMaxThreadCount(QThread::idealThreadCount());
+    }
+
+    ~CompressionQueue()
+    {
+        m_mutex.lock();
+        m_canceled = true;
+        m_mutex.unlock();
+        m_pool.waitForDone();
+        for (Job* job : m_jobs)
+            delete job;
+    }
+
+    bool canEnqueue(qint64 size) const
+    {
+        if (m_jobs.empty())
+            return true;
+        return m_jobs.size() < size_t(MAX_PENDING_ENTRIES_PER_THREAD * m_pool.maxThreadCount())
+                && m_pendingBytes + size <= MAX_PENDING_BYTES;
+    }
+
+    // The compress function is called with a CompressedEntry* to fill in
+    template <typename Function>
+    void enqueue(qint64 size, Function compress)
+    {
+        Job* job = new Job;
+        job->size = size;
+        m_jobs.push_back(job);
+        m_pendingBytes += size;
+        startTask(&m_pool, [=] {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_canceled)
+                    return;
+            }
+            compress(&job->entry);
+            QMutexLocker locker(&m_mutex);
+            job->done = true;
+            m_done.wakeAll();
+        });
+    }
+
+    // Blocks until the oldest enqueued entry is compressed
+    CompressedEntry dequeue()
+    {
+        Q_ASSERT(!m_jobs.empty());
+        Job* job = m_jobs.front();
+        m_jobs.pop_front();
+        m_pendingBytes -= job->size;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!job->done)
+                m_done.wait(&m_mutex);
+        }
+        CompressedEntry entry(std::move(job->entry));
+        delete job;
+        return entry;
+    }
+
+private:
+    struct Job {
+        CompressedEntry entry;
+        qint64 size = 0;
+        bool done = false;
+    };
+
+    std::deque<Job*> m_jobs;
+    qint64 m_pendingBytes;
+    bool m_canceled;
+    QMutex m_mutex;
+    QWaitCondition m_done;
+    QThreadPool m_pool;
+};
+
+/*
+    The directories resolved so far, each one is stored as the index of its parent directory plus
+    its name (UTF-8) in a shared arena, hence full paths are never stored but rebuilt on demand.
+    The source directory itself is the first record, with an empty name.
+*/
+class DirectoryTable final
+{
+public:
+    DirectoryTable() { m_records.push_back({0, 0, 0}); }
+
+    quint32 count() const { return quint32(m_records.size()); }
+
+    quint32 add(quint32 parent, const QByteArray& name)
+    {
+        m_records.push_back({parent, quint32(name.size()), m_names.size()});
+        m_names.append(name);
+        return quint32(m_records.size() - 1);
+    }
+
+    // Writes the path of the directory relative to the source directory (e.g. /a/b) into path
+    void path(quint32 index, QByteArray* path) const
+    {
+        int length = 0;
+        for (quint32 i = index; i != 0; i = m_records[i].parent)
+            length += 1 + m_records[i].nameSize;
+        path->resize(length);
+        char* end = path->data() + length;
+        for (quint32 i = index; i != 0; i = m_records[i].parent) {
+            end -= m_records[i].nameSize;
+            memcpy(end, m_names.constData() + m_records[i].nameOffset, m_records[i].nameSize);
+            *--end = '/';
+        }
+    }
+
+private:
+    struct Record {
+        quint32 parent;
+        quint32 nameSize;
+        int nameOffset;
+    };
+
+    std::vector<Record> m_records;
+    QByteArray m_names;
+};
+
+// A resolved entry, stat data is cached at resolution time so compression never stats again
+struct ResolvedEntry
+{
+    QByteArray name;
+    quint32 parent = 0;
+    qint64 size = 0;
+    MZ_TIME_T lastModified = 0;
+    bool isDir = false;
+    bool isFile = false;
+    bool scheduled = false;
+};
+
+// Resolves the entries of a directory through QDir
+void resolveEntries(const QString& dirPath, quint32 parent, const QStringList& nameFilters,
+                    QDir::Filters filters, std::vector<ResolvedEntry>* entries)
+{
+    for (const QFileInfo& info : QDir(dirPath).entryInfoList({}, filters)) {
+        if (info.isFile() && QDir::match(nameFilters, info.fileName()))
+            continue;
+        ResolvedEntry entry;
+        entry.name = info.fileName().toUtf8();
+        entry.parent = parent;
+        entry.isDir = info.isDir();
+        entry.isFile = info.isFile();
+        if (entry.isFile) {
+            entry.size = info.size();
+            entry.lastModified = info.lastModified().toSecsSinceEpoch();
+        }
+        entries->push_back(std::move(entry));
+    }
+}
+
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+/*
+    Resolves the entries of a directory (opened relative to the rootFd) straight from readdir(),
+    the entry type comes from d_type and fstatat() is only called for the size and modification
+    time of files, or when d_type isn't enough (symbolic links, file systems not filling it in).
+    Applies the same rules QDir does for the Dirs, Files, Hidden, System and NoSymLinks filters,
+    and sorts the entries by name (case insensitive) as QDir does by default. Entries that are only
+    counted (see EntryScanner) skip the fstatat() of files and the sorting.
+*/
+void resolveEntriesNatively(int rootFd, const QByteArray& nativeDir, quint32 parent,
+                            const QStringList& nameFilters, QDir::Filters filters,
+                            std::vector<ResolvedEntry>* entries, bool countOnly = false)
+{
+    const int dirFd = openat(rootFd, nativeDir.isEmpty() ? "." : nativeDir.constData() + 1,
+                             O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0)
+        return;
+
+    DIR* dir = fdopendir(dirFd);
+    if (!dir) {
+        close(dirFd);
+        return;
+    }
+
+    struct NamedEntry {
+        QString name;
+        ResolvedEntry entry;
+    };
+
+    std::vector<NamedEntry> namedEntries;
+    while (const dirent* dirEntry = readdir(dir)) {
+        const char* name = dirEntry->d_name;
+        if (name[0] == '.') {
+            if (name[1] == '\0' || (name[1] == '.' && name[2] == '\0') || !(filters & QDir::Hidden))
+                continue;
+        }
+
+        struct stat status;
+        bool statted = false;
+        unsigned char type = dirEntry->d_type;
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            if (fstatat(dirFd, name, &status, AT_SYMLINK_NOFOLLOW) != 0)
+                continue;
+            if (S_ISLNK(status.st_mode)) {
+                if (filters & QDir::NoSymLinks)
+                    continue;
+                // Links are followed, broken ones are system entries
+                if (fstatat(dirFd, name, &status, 0) != 0)
+                    status.st_mode = 0;
+            }
+            type = S_ISDIR(status.st_mode) ? DT_DIR : S_ISREG(status.st_mode) ? DT_REG : DT_UNKNOWN;
+            statted = true;
+        }
+
+        const bool isDir = type == DT_DIR;
+        const bool isFile = type == DT_REG;
+        if (isDir ? !(filters & (QDir::Dirs | QDir::AllDirs)) : !(filters & QDir::Files))
+            continue;
+        if (!isDir && !isFile && !(filters & QDir::System))
+            continue;
+        if (isFile && !statted && !countOnly && fstatat(dirFd, name, &status, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+
+        NamedEntry namedEntry;
+        namedEntry.name = QFile::decodeName(name);
+        if (isFile && QDir::match(nameFilters, namedEntry.name))
+            continue;
+
+        namedEntry.entry.parent = parent;
+        namedEntry.entry.isDir = isDir;
+        namedEntry.entry.isFile = isFile;
+        if (isFile && !countOnly) {
+            namedEntry.entry.size = status.st_size;
+            namedEntry.entry.lastModified = status.st_mtime;
+        }
+        namedEntries.push_back(std::move(namedEntry));
+    }
+    closedir(dir);
+
+    if (!countOnly) {
+        std::sort(namedEntries.begin(), namedEntries.end(), [] (const NamedEntry& a, const NamedEntry& b) {
+            const int result = a.name.compare(b.name, Qt::CaseInsensitive);
+            return result ? result < 0 : a.name < b.name;
+        });
+    }
+
+    for (NamedEntry& namedEntry : namedEntries) {
+        namedEntry.entry.name = namedEntry.name.toUtf8();
+        entries->push_back(std::move(namedEntry.entry));
+    }
+}
+#endif
+
+ResolvedEntry sourceFileEntry(const QString& sourcePath)
+{
+    const QFileInfo info(sourcePath);
+    ResolvedEntry entry;
+    entry.isFile = true;
+    entry.size = info.size();
+    entry.lastModified = info.lastModified().toSecsSinceEpoch();
+    return entry;
+}
+
+/*
+    Resolves the entries of a directory recursively (breadth first) on a separate thread, while
+    the entries resolved so far are being compressed. Resolved entries are handed over in order
+    through a bounded queue, so the scanner never runs too far ahead of the writer. Entries only
+    hold their name and the index of their parent directory, directories are kept in a table
+    till the end, since they are scanned in the same order they're added into the table.
+    Whenever the queue is full, the scanner counts the entries of the whole tree instead of
+    waiting, one directory at a time (without keeping the entries), so the writer learns the
+    total long before the scan gets to the end of a big tree.
+*/
+class EntryScanner final
+{
+    Q_DISABLE_COPY(EntryScanner)
+
+public:
+    EntryScanner(const QString& sourcePath, const QStringList& nameFilters, QDir::Filters filters)
+        : m_discoveredCount(0)
+        , m_discoveredPathsSize(0)
+        , m_countedCount(0)
+        , m_countedPathsSize(0)
+        , m_nextCountedDirectory(0)
+        , m_counted(false)
+        , m_finished(false)
+        , m_stopped(false)
+    {
+        m_pool.setMaxThreadCount(1);
+        startTask(&m_pool, [=] { scan(sourcePath, nameFilters, filters); });
+    }
+
+    ~EntryScanner()
+    {
+        m_mutex.lock();
+        m_stopped = true;
+        m_notFull.wakeAll();
+        m_mutex.unlock();
+        m_pool.waitForDone();
+    }
+
+    // Waits (up to msecs, or forever if negative) for the next entry, false if none is taken
+    bool take(ResolvedEntry* entry, int msecs = -1)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (msecs < 0) {
+            while (m_entries.empty() && !m_finished)
+                m_notEmpty.wait(&m_mutex);
+        } else if (m_entries.empty() && !m_finished && msecs > 0) {
+            m_notEmpty.wait(&m_mutex, msecs);
+        }
+        if (m_entries.empty())
+            return false;
+        *entry = std::move(m_entries.front());
+        m_entries.pop_front();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    // Takes the next entry only if it is already resolved
+    bool tryTake(ResolvedEntry* entry)
+    {
+        return take(entry, 0);
+    }
+
+    // All the entries are resolved and taken
+    bool atEnd() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_finished && m_entries.empty();
+    }
+
+    size_t discoveredCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_discoveredCount;
+    }
+
+    // Once the scan or the count is over, gives the number of entries and the total size of their
+    // relative paths
+    bool resolvedAll(size_t* count, quint64* pathsSize) const
+    {
+        QMutexLocker locker(&m_mutex);
+        *count = m_finished ? m_discoveredCount : m_countedCount;
+        *pathsSize = m_finished ? m_discoveredPathsSize : m_countedPathsSize;
+        return m_finished || m_counted;
+    }
+
+    // Writes the path of the entry relative to the source directory (UTF-8, e.g. /a/b) into path
+    void relativePath(const ResolvedEntry& entry, QByteArray* path) const
+    {
+        QMutexLocker locker(&m_mutex);
+        m_directories.path(entry.parent, path);
+        path->append('/');
+        path->append(entry.name);
+    }
+
+private:
+    void scan(const QString& sourcePath, const QStringList& nameFilters, QDir::Filters filters)
+    {
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+        // Permission filters are left to QDir
+        const int rootFd = filters & QDir::PermissionMask
+                ? -1 : open(QFile::encodeName(sourcePath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+        const Resolver resolver = {sourcePath, nameFilters, filters, rootFd};
+#else
+        const Resolver resolver = {sourcePath, nameFilters, filters};
+#endif
+        bool stopped = false;
+        QByteArray relativeDir;
+        std::vector<ResolvedEntry> entries;
+        // Only this thread adds directories, so it can read the table without locking
+        for (quint32 directory = 0; !stopped && directory < m_directories.count(); ++directory) {
+            m_directories.path(directory, &relativeDir);
+            resolveDirectory(resolver, relativeDir, directory, &entries);
+            for (ResolvedEntry& entry : entries) {
+                const int pathSize = relativeDir.size() + 1 + entry.name.size();
+                if (!push(resolver, std::move(entry), pathSize)) {
+                    stopped = true;
+                    break;
+                }
+            }
+        }
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+        if (rootFd >= 0)
+            close(rootFd);
+#endif
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+        m_notEmpty.wakeAll();
+    }
+
+    struct Resolver
+    {
+        QString sourcePath;
+        QStringList nameFilters;
+        QDir::Filters filters;
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+        int rootFd;
+#endif
+    };
+
+    static void resolveDirectory(const Resolver& resolver, const QByteArray& relativeDir,
+                                 quint32 directory, std::vector<ResolvedEntry>* entries,
+                                 bool countOnly = false)
+    {
+        entries->clear();
+#if defined(ZIPASYNC_NATIVE_SCANNER)
+        if (resolver.rootFd >= 0) {
+            resolveEntriesNatively(resolver.rootFd, QFile::encodeName(QString::fromUtf8(relativeDir)),
+                                   directory, resolver.nameFilters, resolver.filters, entries,
+                                   countOnly);
+            return;
+        }
+#else
+        Q_UNUSED(countOnly)
+#endif
+        resolveEntries(resolver.sourcePath + QString::fromUtf8(relativeDir), directory,
+                       resolver.nameFilters, resolver.filters, entries);
+    }
+
+    // Counts the entries of the next directory of the count, sets m_counted once the tree is done
+    void countNextDirectory(const Resolver& resolver)
+    {
+        QByteArray relativeDir;
+        std::vector<ResolvedEntry> entries;
+        m_countedDirectories.path(m_nextCountedDirectory, &relativeDir);
+        resolveDirectory(resolver, relativeDir, m_nextCountedDirectory, &entries, true);
+        quint64 pathsSize = 0;
+        for (const ResolvedEntry& entry : entries) {
+            if (entry.isDir)
+                m_countedDirectories.add(m_nextCountedDirectory, entry.name);
+            pathsSize += relativeDir.size() + 1 + entry.name.size();
+        }
+        const bool counted = ++m_nextCountedDirectory == m_countedDirectories.count();
+
+        QMutexLocker locker(&m_mutex);
+        m_countedCount += entries.size();
+        m_countedPathsSize += pathsSize;
+        m_counted = counted;
+    }
+
+    bool push(const Resolver& resolver, ResolvedEntry&& entry, int pathSize)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_entries.size() >= MAX_RESOLVED_AHEAD_ENTRIES && !m_stopped) {
+            if (m_counted) {
+                m_notFull.wait(&m_mutex);
+            } else {
+                // Only this thread uses the count table, the lock only guards the totals
+                locker.unlock();
+                countNextDirectory(resolver);
+                locker.relock();
+            }
+        }
+        if (m_stopped)
+            return false;
+        if (entry.isDir)
+            m_directories.add(entry.parent, entry.name);
+        m_entries.push_back(std::move(entry));
+        ++m_discoveredCount;
+        m_discoveredPathsSize += pathSize;
+        m_notEmpty.wakeAll();
+        return true;
+    }
+
+    DirectoryTable m_directories;
+    std::deque<ResolvedEntry> m_entries;
+    size_t m_discoveredCount;
+    quint64 m_discoveredPathsSize;
+    DirectoryTable m_countedDirectories;
+    size_t m_countedCount;
+    quint64 m_countedPathsSize;
+    quint32 m_nextCountedDirectory;
+    bool m_counted;
+    bool m_finished;
+    bool m_stopped;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QThreadPool m_pool;
+};
+
+// Schedules files ahead of the entry being written, taking the entries the scanner has already
+// resolved, returns the index (within the window) of the next unscheduled entry
+size_t scheduleCompression(CompressionQueue* queue, EntryScanner* scanner,
+                           std::deque<ResolvedEntry>& window, const QString& sourcePath,
+                           CompressionLevel compressionLevel, size_t next)
+{
+    QByteArray relativePath;
+    for (;; ++next) {
+        if (next == window.size()) {
+            ResolvedEntry entry;
+            if (window.size() >= MAX_RESOLVED_AHEAD_ENTRIES || !scanner->tryTake(&entry))
+                break;
+            window.push_back(std::move(entry));
+        }
+        const ResolvedEntry& entry = window[next];
+        if (!entry.isFile || entry.size > MAX_IN_MEMORY_ENTRY_SIZE)
+            continue;
+        if (!queue->canEnqueue(entry.size))
+            break;
+        scanner->relativePath(entry, &relativePath);
+        const QString& filePath = sourcePath + QString::fromUtf8(relativePath);
+        const qint64 size = entry.size;
+        const MZ_TIME_T lastModified = entry.lastModified;
+        queue->enqueue(size, [=] (CompressedEntry* compressedEntry) {
+            compressFile(filePath, size, lastModified, compressionLevel, compressedEntry);
+        });
+        window[next].scheduled = true;
+    }
+    return next;
+}
+
+struct BlockDeflation
+{
+    QString filePath;
+    qint64 size;
+    qint64 blockSize;
+    CompressionLevel compressionLevel;
+    uchar* blockIndex; // Compressed block sizes go here, if the blocks are deflated on their own
+    QFutureInterfaceBase* future;
+};
+
+// mz_zip_deflate_func, deflates blocks in parallel and emits them in order as a single stream
+mz_bool deflateInBlocks(void* opaque, tdefl_put_buf_func_ptr putBuffer, void* userData, mz_uint32* crc32)
+{
+    const BlockDeflation* deflation = static_cast<const BlockDeflation*>(opaque);
+    CompressionQueue queue;
+    qint64 nextOffset = 0;
+    int blockCount = 0;
+    *crc32 = MZ_CRC32_INIT;
+
+    for (qint64 offset = 0; offset < deflation->size;) {
+        while (nextOffset < deflation->size && queue.canEnqueue(deflation->blockSize)) {
+            const qint64 length = qMin(deflation->blockSize, deflation->size - nextOffset);
+            const bool last = nextOffset + length == deflation->size;
+            const bool primed = !deflation->blockIndex;
+            queue.enqueue(length, [=] (CompressedEntry* block) {
+                compressBlock(deflation->filePath, nextOffset, length, last, primed,
+                              deflation->compressionLevel, block);
+            });
+            nextOffset += length;
+        }
+
+        if (deflation->future) {
+            if (deflation->future->isPaused())
+                deflation->future->waitForResume();
+            if (deflation->future->isCanceled())
+                return MZ_FALSE;
+        }
+
+        const CompressedEntry& block = queue.dequeue();
+        if (block.failed || !putBuffer(block.data.constData(), block.data.size(), userData))
+            return MZ_FALSE;
+        if (deflation->blockIndex)
+            qToLittleEndian<quint32>(block.data.size(), deflation->blockIndex + 4 * blockCount++);
+        *crc32 = mz_crc32_combine(*crc32, block.crc32, block.uncompressedSize);
+        offset += block.uncompressedSize;
+    }
+    return MZ_TRUE;
+}
+
+// Size of the blocks of a file deflated on their own, more than DEFLATE_BLOCK_SIZE only if the
+// file would have more than MAX_INDEXED_BLOCKS blocks of that size (files needing blocks bigger
+// than MAX_INDEXED_BLOCK_SIZE aren't indexed)
+qint64 indexedBlockSize(qint64 size)
+{
+    const qint64 blockCount = (size + DEFLATE_BLOCK_SIZE - 1) / DEFLATE_BLOCK_SIZE;
+    return (blockCount + MAX_INDEXED_BLOCKS - 1) / MAX_INDEXED_BLOCKS * DEFLATE_BLOCK_SIZE;
+}
+
+// The central directory extra field that indexes the blocks of a file deflated on their own, so
+// they can be inflated on separate cores: the (uncompressed) block size, then the compressed
+// size of each block, as 32-bit little endian integers. The block sizes are left to be filled in.
+QByteArray blockIndexField(qint64 size, qint64 blockSize)
+{
+    const int blockCount = int((size + blockSize - 1) / blockSize);
+    QByteArray field(BLOCK_INDEX_HEADER_SIZE + 4 * blockCount, 0);
+    uchar* data = reinterpret_cast<uchar*>(field.data());
+    qToLittleEndian<quint16>(BLOCK_INDEX_FIELD_ID, data);
+    qToLittleEndian<quint16>(field.size() - 4, data + 2);
+    qToLittleEndian<quint32>(blockSize, data + 4);
+    return field;
+}
+
+// mz_file_read_func, reads the source file (or device) of an entry being added
+size_t readFromDevice(void* opaque, mz_uint64 offset, void* buffer, size_t length)
+{
+    QIODevice* device = static_cast<QIODevice*>(opaque);
+    if (device->pos() != qint64(offset) && !device->seek(offset))
+        return 0;
+    const qint64 bytesRead = device->read(static_cast<char*>(buffer), length);
+    return bytesRead < 0 ? 0 : size_t(bytesRead);
+}
+
+// Adds a file straight from the disk, big files are deflated in blocks on multiple cores
+bool addFile(mz_zip_archive* zip, const char* archivePath, const QString& filePath, qint64 size,
+             MZ_TIME_T lastModified, CompressionLevel compressionLevel, ZipOptions options,
+             QFutureInterfaceBase* future = nullptr)
+{
+    if (!(options & (ParallelCompression | ParallelDecompression)) || compressionLevel == NoCompression
+            || size <= DEFLATE_BLOCK_SIZE) {
+#if defined(Q_OS_UNIX)
+        // Through stdio, so miniz can copy stored files into the archive within the kernel
+        if (compressionLevel == NoCompression) {
+            FILE* file = fopen(QFile::encodeName(filePath).constData(), "rb");
+            if (!file)
+                return false;
+            const bool added = mz_zip_writer_add_cfile(zip, archivePath, file, size, &lastModified,
+                                                       nullptr, 0, compressionLevel,
+                                                       nullptr, 0, nullptr, 0);
+            fclose(file);
+            return added;
+        }
+#endif
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+        return mz_zip_writer_add_read_buf_callback(zip, archivePath, readFromDevice, &file, size,
+                                                   &lastModified, nullptr, 0, compressionLevel,
+                                                   nullptr, 0, nullptr, 0);
+    }
+
+    BlockDeflation deflation = {filePath, size, DEFLATE_BLOCK_SIZE, compressionLevel, nullptr, future};
+    QByteArray blockIndex;
+    if ((options & ParallelDecompression) && indexedBlockSize(size) <= MAX_INDEXED_BLOCK_SIZE) {
+        deflation.blockSize = indexedBlockSize(size);
+        blockIndex = blockIndexField(size, deflation.blockSize);
+        deflation.blockIndex = reinterpret_cast<uchar*>(blockIndex.data()) + BLOCK_INDEX_HEADER_SIZE;
+    }
+    return mz_zip_writer_add_deflate_callback(zip, archivePath, deflateInBlocks,
+                                              &deflation, size,
+                                              &lastModified, nullptr, 0, compressionLevel,
+                                              nullptr, 0, blockIndex.constData(), blockIndex.size());
+}
+
+/*
+    Stores files (uncompressed) into the archive on a dedicated thread pool. The thread that owns
+    the zip writer adds each file with mz_zip_writer_add_reserved_file(), which writes its headers
+    and leaves room for its data, hence every file has its place in the archive as soon as it is
+    resolved, and the workers copy them in at the same time, with positional writes (pwrite) into a
+    single handle of the archive file opened once per pool (where there is no pwrite, each worker
+    takes a handle of its own from a pool of handles instead). The CRCs are set by the owner thread
+    in finish(), which must be called before the archive is finalized. The workers stop on cancel
+    requests of the future (if any) and as soon as any file fails. Only files of at least
+    MIN_POOLED_STORE_SIZE go through the pool, smaller ones are cheaper to add on the spot.
+*/
+class StoringPool final
+{
+    Q_DISABLE_COPY(StoringPool)
+
+public:
+    explicit StoringPool(const QString& archivePath, QFutureInterfaceBase* future = nullptr)
+        : m_archivePath(archivePath)
+        , m_future(future)
+        , m_pendingCount(0)
+        , m_failed(false)
+    {
+        m_pool.setMaxThreadCount(QThread::idealThreadCount());
+#if defined(Q_OS_UNIX)
+        m_archive.setFileName(archivePath);
+        m_archive.open(QIODevice::ReadWrite);
+#endif
+    }
+
+    ~StoringPool()
+    {
+        m_mutex.lock();
+        m_failed = true;
+        m_mutex.unlock();
+        m_pool.waitForDone();
+        qDeleteAll(m_archives);
+    }
+
+    bool failed() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_failed;
+    }
+
+    QString failedFilePath() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_failedFilePath;
+    }
+
+    // Blocks while the workers are too far behind
+    void enqueue(const QString& filePath, mz_uint fileIndex, mz_uint64 dataOffset, qint64 size)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_pendingCount >= MAX_PENDING_ENTRIES_PER_THREAD * m_pool.maxThreadCount() && !m_failed)
+            m_done.wait(&m_mutex);
+        m_jobs.push_back({filePath, fileIndex, MZ_CRC32_INIT, false});
+        Job* job = &m_jobs.back();
+        ++m_pendingCount;
+        startTask(&m_pool, [=] {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_failed)
+                    return finishJob();
+            }
+            const bool stored = store(filePath, dataOffset, size, &job->crc32);
+            if (!stored)
+                fail(filePath);
+            QMutexLocker locker(&m_mutex);
+            job->done = stored;
+            finishJob();
+        });
+    }
+
+    // Waits for the workers, sets the CRCs of the files stored and drops the files from the first
+    // one that isn't (failed or canceled) on, returns false if any file has ever failed
+    bool finish(mz_zip_archive* zip)
+    {
+        m_pool.waitForDone();
+        for (const Job& job : m_jobs) {
+            if (!job.done || !mz_zip_writer_set_reserved_file_crc32(zip, job.fileIndex, job.crc32)) {
+                mz_zip_writer_discard_files(zip, job.fileIndex);
+                if (job.done)
+                    fail(job.filePath);
+                break;
+            }
+        }
+        m_jobs.clear();
+        return !failed();
+    }
+
+private:
+    struct Job {
+        QString filePath;
+        mz_uint fileIndex;
+        mz_uint32 crc32;
+        bool done;
+    };
+
+    // The archive starts at the beginning of its file, so data offsets are file offsets
+    bool store(const QString& filePath, mz_uint64 dataOffset, qint64 size, mz_uint32* crc32)
+    {
+        QFile source(filePath);
+        if (!source.open(QIODevice::ReadOnly))
+            return false;
+        QFile* archive = takeArchive();
+        if (!archive)
+            return false;
+
+        QByteArray buffer;
+        buffer.resize(int(qMin(size, qint64(STORE_BUFFER_SIZE))));
+        bool stored = true;
+        for (qint64 written = 0; written < size && stored;) {
+            const qint64 length = qMin(size - written, qint64(buffer.size()));
+            stored = !(m_future && m_future->isCanceled())
+                    && source.read(buffer.data(), length) == length
+                    && writeAt(archive, qint64(dataOffset) + written, buffer.constData(), length);
+            *crc32 = mz_uint32(mz_crc32(*crc32, reinterpret_cast<const mz_uint8*>(buffer.constData()),
+                                        size_t(length)));
+            written += length;
+        }
+        return releaseArchive(archive) && stored;
+    }
+
+    // Returns the handle of the archive shared by the workers, or (without pwrite) an idle one of
+    // the handles opened so far, opening a new one if all are in use
+    QFile* takeArchive()
+    {
+#if defined(Q_OS_UNIX)
+        return m_archive.isOpen() ? &m_archive : nullptr;
+#else
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_archives.empty()) {
+                QFile* archive = m_archives.back();
+                m_archives.pop_back();
+                return archive;
+            }
+        }
+        QScopedPointer<QFile> archive(new QFile(m_archivePath));
+        return archive->open(QIODevice::ReadWrite) ? archive.take() : nullptr;
+#endif
+    }
+
+    bool releaseArchive(QFile* archive)
+    {
+#if defined(Q_OS_UNIX)
+        Q_UNUSED(archive)
+        return true;
+#else
+        const bool flushed = archive->flush();
+        QMutexLocker locker(&m_mutex);
+        m_archives.push_back(archive);
+        return flushed;
+#endif
+    }
+
+    static bool writeAt(QFile* archive, qint64 offset, const char* data, qint64 length)
+    {
+#if defined(Q_OS_UNIX)
+        while (length > 0) {
+            const ssize_t written = ::pwrite(archive->handle(), data, size_t(length), off_t(offset));
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            offset += written;
+            data += written;
+            length -= written;
+        }
+        return true;
+#else
+        return archive->seek(offset) && archive->write(data, length) == length;
+#endif
+    }
+
+    void fail(const QString& filePath)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_failed) {
+            m_failed = true;
+            m_failedFilePath = filePath;
+        }
+    }
+
+    // Called with the mutex locked
+    void finishJob()
+    {
+        --m_pendingCount;
+        m_done.wakeAll();
+    }
+
+    const QString m_archivePath;
+    QFile m_archive;
+    std::vector<QFile*> m_archives;
+    QFutureInterfaceBase* m_future;
+    std::deque<Job> m_jobs;
+    int m_pendingCount;
+    bool m_failed;
+    QString m_failedFilePath;
+    mutable QMutex m_mutex;
+    QWaitCondition m_done;
+    QThreadPool m_pool;
+};
+
+struct DeviceOutput
+{
+    QIODevice* device;
+    qint64 startPosition;
+};
+
+// mz_file_write_func, writes the archive into a (random access) device
+size_t writeToDevice(void* opaque, mz_uint64 offset, const void* buffer, size_t length)
+{
+    const DeviceOutput* output = static_cast<const DeviceOutput*>(opaque);
+    const qint64 position = output->startPosition + qint64(offset);
+    if (output->device->pos() != position && !output->device->seek(position))
+        return 0;
+    const qint64 bytesWritten = output->device->write(static_cast<const char*>(buffer), length);
+    return bytesWritten < 0 ? 0 : size_t(bytesWritten);
+}
+
+MZ_TIME_T lastModifiedTime(const ZipEntry& entry)
+{
+    if (entry.lastModified.isValid())
+        return entry.lastModified.toSecsSinceEpoch();
+    return QDateTime::currentDateTime().toSecsSinceEpoch();
+}
+
+// Schedules data entries ahead of the entry being written, returns the index of the next unscheduled entry
+int scheduleCompression(CompressionQueue* queue, const QList<ZipEntry>& entries,
+                        std::vector<bool>& scheduled, CompressionLevel compressionLevel, int next)
+{
+    for (; next < entries.size(); ++next) {
+        const ZipEntry& entry = entries.at(next);
+        if (entry.device)
+            continue;
+        if (!queue->canEnqueue(entry.data.size()))
+            break;
+        const QByteArray data(entry.data);
+        const MZ_TIME_T lastModified = lastModifiedTime(entry);
+        queue->enqueue(data.size(), [=] (CompressedEntry* compressedEntry) {
+            compressData(data, lastModified, compressionLevel, compressedEntry);
+        });
+        scheduled[next] = true;
+    }
+    return next;
+}
+
+// Adds the whole content of a device, streamed unless the device is sequential
+bool addDevice(mz_zip_archive* zip, const char* archivePath, QIODevice* device,
+               MZ_TIME_T lastModified, CompressionLevel compressionLevel)
+{
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly))
+        return false;
+    if (!device->isReadable())
+        return false;
+
+    if (device->isSequential()) {
+        const QByteArray& data = device->readAll();
+        return mz_zip_writer_add_mem_ex_v2(zip, archivePath, data.constData(), data.size(),
+                                           nullptr, 0, compressionLevel, 0, 0, &lastModified,
+                                           nullptr, 0, nullptr, 0);
+    }
+    return mz_zip_writer_add_read_buf_callback(zip, archivePath, readFromDevice, device, device->size(),
+                                               &lastModified, nullptr, 0, compressionLevel,
+                                               nullptr, 0, nullptr, 0);
+}
+
+QString entryName(const mz_zip_archive_entry_view& entry)
+{
+    return QString::fromUtf8(entry.m_pFilename, entry.m_filename_size);
+}
+
+// Creates the directory on disk, unless it (or any of its subdirectories) is created before
+bool makePath(const QString& destinationPath, QString relativePath, QSet<QString>* createdPaths)
+{
+    while (relativePath.endsWith('/'))
+        relativePath.chop(1);
+    if (relativePath.isEmpty() || createdPaths->contains(relativePath))
+        return true;
+    if (!QDir(destinationPath).mkpath(relativePath))
+        return false;
+    while (!relativePath.isEmpty() && !createdPaths->contains(relativePath)) {
+        createdPaths->insert(relativePath);
+        relativePath.truncate(qMax(0, relativePath.lastIndexOf('/')));
+    }
+    return true;
+}
+
+// The blocks of an entry deflated on their own each, with their offsets in its compressed data
+struct BlockIndex
+{
+    mz_uint64 blockSize = 0;
+    std::vector<mz_uint64> offsets; // Plus the end of the last block
+};
+
+// Reads the index of an entry written with the ParallelDecompression option (see blockIndexField()),
+// false if it has none or it doesn't match the entry, which is then extracted as a whole. The field
+// comes from the archive, so the block count is taken from its size and checked against the entry
+// rather than computed from the block size, which is capped at MAX_INDEXED_BLOCK_SIZE.
+bool readBlockIndex(mz_zip_archive* zip, const mz_zip_archive_entry_view& entry, BlockIndex* index)
+{
+    const void* field;
+    mz_uint16 fieldSize;
+    if (entry.m_method != MZ_DEFLATED
+            || !mz_zip_reader_get_extra_field(zip, entry.m_file_index, BLOCK_INDEX_FIELD_ID,
+                                              &field, &fieldSize)
+            || fieldSize < 4 || fieldSize % 4) {
+        return false;
+    }
+
+    const uchar* data = static_cast<const uchar*>(field);
+    index->blockSize = qFromLittleEndian<quint32>(data);
+    if (!index->blockSize || index->blockSize > MAX_INDEXED_BLOCK_SIZE)
+        return false;
+
+    // The last block holds between 1 and blockSize bytes (both factors are small enough not to overflow)
+    const mz_uint64 blockCount = (fieldSize - 4) / 4;
+    if (blockCount < 2 || entry.m_uncomp_size <= (blockCount - 1) * index->blockSize
+            || entry.m_uncomp_size > blockCount * index->blockSize) {
+        return false;
+    }
+
+    index->offsets.resize(blockCount + 1);
+    index->offsets[0] = 0;
+    for (mz_uint64 i = 0; i < blockCount; ++i)
+        index->offsets[i + 1] = index->offsets[i] + qFromLittleEndian<quint32>(data + 4 + 4 * i);
+    return index->offsets.back() == entry.m_comp_size;
+}
+
+/*
+    Extracts the given file entries on a dedicated thread pool (one thread per processor core).
+    All workers share the same zip reader, which is safe since miniz reads archive files either
+    through a memory mapping or with positional I/O (pread), and the central directory is only
+    read from then on. The workers pick the entries in order, honor pause/cancel requests of the
+    future (if any) and stop as soon as any entry fails. Entries with a block index are split
+    into one job per block instead, so all workers inflate a big entry together, each writing its
+    blocks in place, and the one that finishes the last block checks the CRC of the whole file.
+    The directories must be created beforehand, and the zip reader must outlive the pool.
+*/
+class ExtractionPool final
+{
+    Q_DISABLE_COPY(ExtractionPool)
+
+public:
+    ExtractionPool(mz_zip_archive* zip, const QString& destinationPath,
+                   const std::vector<mz_zip_archive_entry_view>& files,
+                   QFutureInterfaceBase* future = nullptr)
+        : m_zip(zip)
+        , m_destinationPath(destinationPath)
+        , m_files(files)
+        , m_future(future)
+        , m_failed(false)
+    {
+        m_jobs.reserve(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            BlockIndex index;
+            if (!readBlockIndex(zip, files[i], &index)) {
+                m_jobs.push_back({i, 0, nullptr});
+                continue;
+            }
+            const int blockCount = int(index.offsets.size() - 1);
+            m_splitFiles.emplace_back();
+            SplitFile* splitFile = &m_splitFiles.back();
+            splitFile->index = std::move(index);
+            splitFile->crcs.resize(blockCount);
+            splitFile->remainingBlocks.storeRelease(blockCount);
+            for (int block = 0; block < blockCount; ++block)
+                m_jobs.push_back({i, block, splitFile});
+        }
+
+        const int threadCount = qMax(1, qMin(QThread::idealThreadCount(), int(m_jobs.size())));
+        m_pool.setMaxThreadCount(threadCount);
+        for (int i = 0; i < threadCount; ++i)
+            startTask(&m_pool, [this] { work(); });
+    }
+
+    ~ExtractionPool()
+    {
+        m_stopped.storeRelease(1);
+        m_pool.waitForDone();
+    }
+
+    bool waitForDone(int msecs = -1)
+    {
+        return m_pool.waitForDone(msecs);
+    }
+
+    mz_uint extractedCount() const
+    {
+        return mz_uint(m_extractedCount.loadAcquire());
+    }
+
+    bool failed() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_failed;
+    }
+
+    QString failedFilePath() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_failedFilePath;
+    }
+
+private:
+    // An entry extracted block by block
+    struct SplitFile
+    {
+        BlockIndex index;
+        std::vector<mz_uint32> crcs;
+        QAtomicInt remainingBlocks;
+        QMutex mutex;
+        bool created = false;
+    };
+
+    struct Job
+    {
+        size_t file;
+        int block;
+        SplitFile* splitFile; // Null if the whole file is extracted at once
+    };
+
+    void work()
+    {
+        QByteArray buffer;
+        while (!m_stopped.loadAcquire()) {
+            if (m_future) {
+                if (m_future->isPaused())
+                    m_future->waitForResume();
+                if (m_future->isCanceled())
+                    break;
+            }
+
+            const int next = m_next.fetchAndAddRelaxed(1);
+            if (next >= int(m_jobs.size()))
+                break;
+
+            const Job& job = m_jobs[next];
+            const mz_zip_archive_entry_view& file = m_files[job.file];
+            const QString& filePath = m_destinationPath + '/' + entryName(file);
+            if (job.splitFile) {
+                if (!extractBlock(file, filePath, job.splitFile, job.block, &buffer)) {
+                    fail(filePath);
+                    break;
+                }
+                continue;
+            }
+            if (!mz_zip_reader_extract_to_file(m_zip, file.m_file_index, filePath.toUtf8().constData(), 0)) {
+                fail(filePath);
+                break;
+            }
+            m_extractedCount.fetchAndAddRelease(1);
+        }
+    }
+
+    // Inflates a block of the file and writes it in place, the first block done creates the file
+    // and the last one completes it
+    bool extractBlock(const mz_zip_archive_entry_view& file, const QString& filePath,
+                      SplitFile* splitFile, int block, QByteArray* buffer)
+    {
+        const BlockIndex& index = splitFile->index;
+        const mz_uint64 offset = block * index.blockSize;
+        const int size = int(qMin(index.blockSize, file.m_uncomp_size - offset)); // At most MAX_INDEXED_BLOCK_SIZE
+        buffer->resize(size);
+        if (!mz_zip_reader_extract_part_to_mem(m_zip, file.m_file_index, index.offsets[block],
+                                               index.offsets[block + 1] - index.offsets[block],
+                                               buffer->data(), size, &splitFile->crcs[block])) {
+            return false;
+        }
+
+        QFile output(filePath);
+        {
+            QMutexLocker locker(&splitFile->mutex);
+            if (!splitFile->created) {
+                if (!output.open(QIODevice::WriteOnly) || !output.resize(file.m_uncomp_size))
+                    return false;
+                splitFile->created = true;
+            }
+        }
+        if (!output.isOpen() && !output.open(QIODevice::ReadWrite))
+            return false;
+        if (!output.seek(offset) || output.write(*buffer) != buffer->size() || !output.flush())
+            return false;
+        output.close();
+
+        if (splitFile->remainingBlocks.fetchAndAddOrdered(-1) > 1)
+            return true;
+
+        mz_uint32 crc32 = MZ_CRC32_INIT;
+        for (size_t i = 0; i < splitFile->crcs.size(); ++i) {
+            const mz_uint64 blockSize = qMin(index.blockSize, file.m_uncomp_size - i * index.blockSize);
+            crc32 = mz_crc32_combine(crc32, splitFile->crcs[i], blockSize);
+        }
+        if (crc32 != file.m_crc32)
+            return false;
+
+#ifndef MINIZ_NO_TIME
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(m_zip, file.m_file_index, &stat) || !output.open(QIODevice::ReadWrite)
+                || !output.setFileTime(QDateTime::fromSecsSinceEpoch(stat.m_time),
+                                       QFileDevice::FileModificationTime)) {
+            return false;
+        }
+#endif
+        m_extractedCount.fetchAndAddRelease(1);
+        return true;
+    }
+
+    void fail(const QString& filePath)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_failed) {
+            m_failed = true;
+            m_failedFilePath = filePath;
+        }
+        m_stopped.storeRelease(1);
+    }
+
+    mz_zip_archive* m_zip;
+    const QString m_destinationPath;
+    const std::vector<mz_zip_archive_entry_view>& m_files;
+    std::vector<Job> m_jobs;
+    std::deque<SplitFile> m_splitFiles;
+    QFutureInterfaceBase* m_future;
+    QAtomicInt m_next;
+    QAtomicInt m_extractedCount;
+    QAtomicInt m_stopped;
+    bool m_failed;
+    QString m_failedFilePath;
+    mutable QMutex m_mutex;
+    QThreadPool m_pool;
+};
 
 bool touch(const QString& filePath)
 {
@@ -73,57 +1594,85 @@ QByteArray cleanArchivePath(const QString& rootDirectory, const QString& relativ
     return archivePath.toUtf8();
 }
 
-QByteArray cleanArchivePath(const QString& rootDirectory, const QString& relativePath, bool isDir)
+// Returns the writer init flags for the options, setting the alignment up if needed
+mz_uint writerFlags(mz_zip_archive* zip, ZipOptions options)
+{
+    if (!(options & AlignStoredData))
+        return 0;
+    zip->m_file_offset_alignment = STORED_DATA_ALIGNMENT;
+    return MZ_ZIP_FLAG_WRITE_ALIGN_STORED_DATA;
+}
+
+QByteArray cleanRootDirectory(const QString& rootDirectory)
+{
+    if (rootDirectory.startsWith('/'))
+        return rootDirectory.mid(1).toUtf8();
+    return rootDirectory.toUtf8();
+}
+
+// Writes the archive path of an entry into a reused buffer: the root directory (see
+// cleanRootDirectory()) followed by the UTF-8 relative path (e.g. /a/b), whose leading slash is
+// dropped if there is no root directory, plus a trailing slash for directories
+void makeArchivePath(const QByteArray& root, const QByteArray& relativePath, bool isDir,
+                     QByteArray* archivePath)
 {
     Q_ASSERT(!relativePath.isEmpty());
-    QString archivePath(relativePath);
-    if (rootDirectory.isEmpty()) {
-        if (archivePath[0] == '/')
-            archivePath.remove(0, 1);
+    if (root.isEmpty()) {
+        archivePath->resize(relativePath.size() - 1);
+        memcpy(archivePath->data(), relativePath.constData() + 1, relativePath.size() - 1);
     } else {
-        QString root(rootDirectory);
-        if (root[0] == '/')
-            root.remove(0, 1);
-        archivePath.prepend(root);
-        if (root.isEmpty()) {
-            if (archivePath[0] == '/')
-                archivePath.remove(0, 1);
-        }
+        archivePath->resize(root.size() + relativePath.size());
+        memcpy(archivePath->data(), root.constData(), root.size());
+        memcpy(archivePath->data() + root.size(), relativePath.constData(), relativePath.size());
     }
     if (isDir)
-        archivePath += '/';
-    return archivePath.toUtf8();
+        archivePath->append('/');
+}
+
+// Reserves the central directory for the entries left as soon as the scanner knows how many there
+// are, so a big one isn't reallocated and copied over every time it runs out of room. Trees of up
+// to MAX_RESOLVED_AHEAD_ENTRIES entries are resolved before the writer gets far, bigger ones are
+// counted by the scanner while it waits for the writer (see EntryScanner).
+void reserveCentralDirectory(mz_zip_archive* zip, const EntryScanner* scanner, const QByteArray& root,
+                             size_t entryCount, quint64 namesSize, bool* reserved)
+{
+    size_t count;
+    quint64 pathsSize;
+    if (*reserved || !scanner->resolvedAll(&count, &pathsSize))
+        return;
+    *reserved = true;
+    // Upper bound, names get the root directory (or lose the leading slash) and maybe a trailing slash
+    const quint64 totalNamesSize = pathsSize + quint64(count) * (root.size() + 1);
+    mz_zip_writer_reserve_central_dir(zip, mz_uint(count - entryCount),
+                                      totalNamesSize > namesSize ? totalNamesSize - namesSize : 0);
 }
 
 size_t zipSync(const QString& sourcePath, const QString& destinationZipPath,
                const QString& rootDirectory, const QStringList& nameFilters,
-               QDir::Filters filters, CompressionLevel compressionLevel, bool append)
+               QDir::Filters filters, CompressionLevel compressionLevel, bool append,
+               ZipOptions options)
 {
     const bool sourceIsAFile = QFileInfo(sourcePath).isFile();
-    QScopedPointer<std::vector<QString>> vector(new std::vector<QString>({""}));
-    vector->reserve(INITIAL_NUMBER_OF_ENTRIES);
+    QScopedPointer<EntryScanner> scanner;
+    std::deque<ResolvedEntry> window;
 
-    // Recursive entry resolution
+    // Recursive entry resolution (runs alongside the compression)
     if (sourceIsAFile) {
-        vector->push_back(QString());
+        window.push_back(sourceFileEntry(sourcePath));
     } else {
-        for (size_t i = 0; i < vector->size(); ++i) {
-            const QString& path = sourcePath + vector->at(i);
-            if (QFileInfo(path).isDir()) {
-                for (const QString& entryName : QDir(path).entryList({}, filters)) {
-                    if (!QDir::match(nameFilters, entryName) || !QFileInfo(path + '/' + entryName).isFile())
-                        vector->push_back(vector->at(i) + '/' + entryName);
-                }
-            }
-        }
+        ResolvedEntry entry;
+        scanner.reset(new EntryScanner(sourcePath, nameFilters, filters));
+        if (scanner->take(&entry))
+            window.push_back(std::move(entry));
     }
-    vector->shrink_to_fit();
 
-    if (vector->size() <= 1)
+    if (window.empty())
         return WARNING("Nothing to compress, the source directory is empty.");
 
+    Arena arena;
     mz_zip_archive zip;
     memset(&zip, 0, sizeof(zip));
+    arena.install(&zip);
 
     // Archive initialization
     if (append && QFileInfo::exists(destinationZipPath)) {
@@ -133,40 +1682,120 @@ size_t zipSync(const QString& sourcePath, const QString& destinationZipPath,
                     MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY, 0, 0)) {
             return WARNING("Couldn't initialize a zip reader.");
         }
-        if (!mz_zip_writer_init_from_reader_v2(&zip, destinationZipPath.toUtf8().constData(), 0)) {
+        if (!mz_zip_writer_init_from_reader_v2(&zip, destinationZipPath.toUtf8().constData(),
+                                               writerFlags(&zip, options))) {
             mz_zip_reader_end(&zip);
             return WARNING("Couldn't initialize a zip writer.");
         }
     } else {
-        if (!mz_zip_writer_init_file_v2(&zip, destinationZipPath.toUtf8().constData(), 0, 0))
+        if (!mz_zip_writer_init_file_v2(&zip, destinationZipPath.toUtf8().constData(), 0,
+                                        writerFlags(&zip, options)))
             return WARNING("Couldn't initialize a zip writer.");
     }
 
     // Compressing and adding entries
-    for (size_t i = 1; i < vector->size(); ++i) {
-        const QString& path = sourceIsAFile ? sourcePath : (sourcePath + vector->at(i));
-        const bool isDir = QFileInfo(path).isDir();
-        const QByteArray& archivePath = sourceIsAFile
-                ? cleanArchivePath(rootDirectory, QFileInfo(sourcePath).fileName())
-                : cleanArchivePath(rootDirectory, vector->at(i), isDir);
-
-        if (isDir) {
-            if (!mz_zip_writer_add_mem(&zip, archivePath.constData(), nullptr, 0, 0)) {
-                mz_zip_writer_finalize_archive(&zip);
-                mz_zip_writer_end(&zip);
-                return WARNING("Couldn't add a directory entry for: %s.", path.toUtf8().constData());
-            }
+    QScopedPointer<CompressionQueue> queue;
+    QScopedPointer<StoringPool> storingPool;
+    size_t nextToSchedule = 0;
+    size_t entryCount = 0;
+    quint64 namesSize = 0;
+    bool reserved = false;
+    QByteArray relativePath;
+    QByteArray archivePath;
+    const QByteArray& root = cleanRootDirectory(rootDirectory);
+    const bool useStoringPool = options & ParallelCompression && !sourceIsAFile
+                                && compressionLevel == NoCompression;
+    if (options & ParallelCompression && !sourceIsAFile && compressionLevel != NoCompression)
+        queue.reset(new CompressionQueue);
+
+    while (!window.empty()) {
+        if (storingPool && storingPool->failed())
+            break;
+        if (scanner)
+            reserveCentralDirectory(&zip, scanner.data(), root, entryCount, namesSize, &reserved);
+        if (queue)
+            nextToSchedule = scheduleCompression(queue.data(), scanner.data(), window, sourcePath,
+                                                 compressionLevel, nextToSchedule);
+
+        const ResolvedEntry entry(std::move(window.front()));
+        window.pop_front();
+        if (nextToSchedule > 0)
+            --nextToSchedule;
+
+        if (sourceIsAFile) {
+            archivePath = cleanArchivePath(rootDirectory, QFileInfo(sourcePath).fileName());
         } else {
-            if (!mz_zip_writer_add_file(&zip, archivePath, path.toUtf8().constData(),
-                                        nullptr, 0, compressionLevel)) {
+            scanner->relativePath(entry, &relativePath);
+            makeArchivePath(root, relativePath, entry.isDir, &archivePath);
+        }
+        const QString& path = sourceIsAFile ? sourcePath : (sourcePath + QString::fromUtf8(relativePath));
+
+        if (entry.scheduled) {
+            CompressedEntry compressedEntry(queue->dequeue());
+            if (compressedEntry.failed
+                    || !addCompressedEntry(&zip, archivePath, &compressedEntry, compressionLevel)) {
                 mz_zip_writer_finalize_archive(&zip);
                 mz_zip_writer_end(&zip);
                 return WARNING("Couldn't compress the file: %s.", path.toUtf8().constData());
             }
+        } else {
+            if (entry.isDir) {
+                if (!mz_zip_writer_add_mem(&zip, archivePath.constData(), nullptr, 0, 0)) {
+                    if (storingPool)
+                        storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    // Cut off the data of the files the storing pool dropped
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return WARNING("Couldn't add a directory entry for: %s.", path.toUtf8().constData());
+                }
+            } else if (useStoringPool && entry.size >= MIN_POOLED_STORE_SIZE) {
+                if (!storingPool)
+                    storingPool.reset(new StoringPool(destinationZipPath));
+                mz_uint64 dataOffset;
+                if (!mz_zip_writer_add_reserved_file(&zip, archivePath.constData(), entry.size,
+                                                     &entry.lastModified, &dataOffset)) {
+                    storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return WARNING("Couldn't compress the file: %s.", path.toUtf8().constData());
+                }
+                storingPool->enqueue(path, zip.m_total_files - 1, dataOffset, entry.size);
+            } else {
+                if (!addFile(&zip, archivePath, path, entry.size, entry.lastModified,
+                             compressionLevel, options)) {
+                    if (storingPool)
+                        storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    // Cut off the partially written entry
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return WARNING("Couldn't compress the file: %s.", path.toUtf8().constData());
+                }
+            }
         }
+        ++entryCount;
+        namesSize += archivePath.size();
+
+        // Wait for the scanner, if the writer caught up with it
+        ResolvedEntry nextEntry;
+        if (window.empty() && scanner && scanner->take(&nextEntry))
+            window.push_back(std::move(nextEntry));
     }
 
     // Archive finalization
+    if (storingPool && !storingPool->finish(&zip)) {
+        mz_zip_writer_finalize_archive(&zip);
+        const mz_uint64 archiveSize = zip.m_archive_size;
+        mz_zip_writer_end(&zip);
+        // Cut off the files that couldn't be stored
+        QFile::resize(destinationZipPath, archiveSize);
+        return WARNING("Couldn't compress the file: %s.", storingPool->failedFilePath().toUtf8().constData());
+    }
     if (!mz_zip_writer_finalize_archive(&zip)) {
         mz_zip_writer_end(&zip);
         return WARNING("Couldn't finalize the zip writer.");
@@ -174,7 +1803,7 @@ size_t zipSync(const QString& sourcePath, const QString& destinationZipPath,
     if (!mz_zip_writer_end(&zip))
         return WARNING("Couldn't clean the zip writer cache.");
 
-    return vector->size() - 1;
+    return entryCount;
 }
 
 size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, bool overwrite)
@@ -183,8 +1812,10 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
     QString sourceZipFinalPath(sourceZipPath);
     copyResourceFile(sourceZipFinalPath, tempDir);
 
+    Arena arena;
     mz_zip_archive zip;
     memset(&zip, 0, sizeof(zip));
+    arena.install(&zip);
     if (!mz_zip_reader_init_file_v2(&zip, sourceZipFinalPath.toUtf8().constData(), 0, 0, 0))
         return WARNING("Couldn't initialize a zip reader.");
 
@@ -195,61 +1826,67 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
         return WARNING("The archive is either invalid or empty.");
     }
 
-    // Iterate for dirs
+    // Scan the central directory once
+    std::vector<mz_zip_archive_entry_view> entries(numberOfEntries);
     for (mz_uint i = 0; i < numberOfEntries; ++i) {
-        mz_zip_archive_file_stat fileStat;
-        if (!mz_zip_reader_file_stat(&zip, i, &fileStat)) {
+        if (!mz_zip_reader_entry_view(&zip, i, &entries[i])) {
             mz_zip_reader_end(&zip);
             return WARNING("Archive is broken.");
         }
-        if (!fileStat.m_is_supported) {
+        if (!entries[i].m_is_supported) {
             mz_zip_reader_end(&zip);
             return WARNING("Archive isn't supported.");
         }
-        if (fileStat.m_is_directory) {
+    }
+
+    // Create dirs (including parent dirs of files) and collect files
+    QSet<QString> createdPaths;
+    std::vector<mz_zip_archive_entry_view> files;
+    files.reserve(numberOfEntries);
+    for (const mz_zip_archive_entry_view& entry : entries) {
+        const QString& name = entryName(entry);
+        if (entry.m_is_directory) {
             if (!overwrite) {
-                const bool isBase = QString(fileStat.m_filename).count('/') <= 1;
-                if (isBase && QFileInfo::exists(destinationPath + '/' + fileStat.m_filename)) {
+                const bool isBase = name.count('/') <= 1;
+                if (isBase && !createdPaths.contains(name.left(name.size() - 1))
+                        && QFileInfo::exists(destinationPath + '/' + name)) {
                     mz_zip_reader_end(&zip);
                     return WARNING("Extraction canceled, dir already exists: %s.",
-                            (destinationPath + '/' + fileStat.m_filename).toUtf8().constData());
+                            (destinationPath + '/' + name).toUtf8().constData());
                 }
             }
-            if (!QDir(destinationPath).mkpath(fileStat.m_filename)) {
+            if (!makePath(destinationPath, name, &createdPaths)) {
                 mz_zip_reader_end(&zip);
                 return WARNING("Directory creation on disk is failed for: %s.",
-                        (destinationPath + '/' + fileStat.m_filename).toUtf8().constData());
+                        (destinationPath + '/' + name).toUtf8().constData());
             }
-        }
-    }
-
-    // Iterate for files
-    for (mz_uint i = 0; i < numberOfEntries; ++i) {
-        mz_zip_archive_file_stat fileStat;
-        if (!mz_zip_reader_file_stat(&zip, i, &fileStat)) {
-            mz_zip_reader_end(&zip);
-            return WARNING("Archive is broken.");
-        }
-        if (!fileStat.m_is_supported) {
-            mz_zip_reader_end(&zip);
-            return WARNING("Archive isn't supported.");
-        }
-        if (!fileStat.m_is_directory) {
+        } else {
             if (!overwrite) {
-                const bool isBase = QString(fileStat.m_filename).count('/') < 1;
-                if (isBase && QFileInfo::exists(destinationPath + '/' + fileStat.m_filename)) {
+                const bool isBase = name.count('/') < 1;
+                if (isBase && QFileInfo::exists(destinationPath + '/' + name)) {
                     mz_zip_reader_end(&zip);
                     return WARNING("Extraction canceled, file already exists: %s.",
-                            (destinationPath + '/' + fileStat.m_filename).toUtf8().constData());
+                            (destinationPath + '/' + name).toUtf8().constData());
                 }
             }
-            if (!mz_zip_reader_extract_to_file(
-                        &zip, i, (destinationPath + '/' + fileStat.m_filename).toUtf8().constData(),
-                        0)) {
+            const QString& parent = name.left(qMax(0, name.lastIndexOf('/')));
+            if (!makePath(destinationPath, parent, &createdPaths)) {
                 mz_zip_reader_end(&zip);
-                return WARNING("Extraction failed, file: %s.",
-                        (destinationPath + '/' + fileStat.m_filename).toUtf8().constData());
+                return WARNING("Directory creation on disk is failed for: %s.",
+                        (destinationPath + '/' + parent).toUtf8().constData());
             }
+            files.push_back(entry);
+        }
+    }
+
+    // Extract files in parallel
+    if (!files.empty()) {
+        ExtractionPool pool(&zip, destinationPath, files);
+        pool.waitForDone();
+        if (pool.failed()) {
+            mz_zip_reader_end(&zip);
+            return WARNING("Extraction failed, file: %s.",
+                           pool.failedFilePath().toUtf8().constData());
         }
     }
 
@@ -261,41 +1898,40 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
 
 size_t zip(QFutureInterfaceBase* futureInterface, const QString& sourcePath,
            const QString& destinationZipPath, const QString& rootDirectory, const QStringList& nameFilters,
-           QDir::Filters filters, CompressionLevel compressionLevel, bool append)
+           QDir::Filters filters, CompressionLevel compressionLevel, bool append, ZipOptions options)
 {
     INITIALIZE(size_t, futureInterface)
 
     const bool sourceIsAFile = QFileInfo(sourcePath).isFile();
-    QScopedPointer<std::vector<QString>> vector(new std::vector<QString>({""}));
-    vector->reserve(INITIAL_NUMBER_OF_ENTRIES);
+    QScopedPointer<EntryScanner> scanner;
+    std::deque<ResolvedEntry> window;
 
-    // Recursive entry resolution
+    // Recursive entry resolution (runs alongside the compression)
     if (sourceIsAFile) {
-        vector->push_back(QString());
+        window.push_back(sourceFileEntry(sourcePath));
     } else {
-        for (size_t i = 0; i < vector->size(); ++i) {
-            const QString& path = sourcePath + vector->at(i);
-            if (QFileInfo(path).isDir()) {
-                for (const QString& entryName : QDir(path).entryList({}, filters)) {
-                    if (!QDir::match(nameFilters, entryName) || !QFileInfo(path + '/' + entryName).isFile())
-                        vector->push_back(vector->at(i) + '/' + entryName);
-                }
+        ResolvedEntry entry;
+        scanner.reset(new EntryScanner(sourcePath, nameFilters, filters));
+        while (!scanner->atEnd()) {
+            if (scanner->take(&entry, 40)) {
+                window.push_back(std::move(entry));
+                break;
             }
-            if (vector->size() > 1)
-                REPORT_RESULT_UNSAFE(vector->size() - 1)
+            if (future->isCanceled())
+                return 0;
         }
     }
-    vector->shrink_to_fit();
 
-    if (vector->size() <= 1)
+    if (window.empty())
         return CRASH(future, "Nothing to compress, the source directory is empty.");
 
-    REPORT(1, vector->size() - 1)
+    size_t reportedCount = sourceIsAFile ? 1 : scanner->discoveredCount();
+    REPORT(1, reportedCount)
 
+    Arena arena;
     mz_zip_archive zip;
-    qreal progress = 1;
-    qreal step = (99. - progress) / (vector->size() - 1);
     memset(&zip, 0, sizeof(zip));
+    arena.install(&zip);
 
     // Archive initialization
     if (append && QFileInfo::exists(destinationZipPath)) {
@@ -305,43 +1941,148 @@ size_t zip(QFutureInterfaceBase* futureInterface, const QString& sourcePath,
                     MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY, 0, 0)) {
             return CRASH(future, "Couldn't initialize a zip reader.");
         }
-        if (!mz_zip_writer_init_from_reader_v2(&zip, destinationZipPath.toUtf8().constData(), 0)) {
+        if (!mz_zip_writer_init_from_reader_v2(&zip, destinationZipPath.toUtf8().constData(),
+                                               writerFlags(&zip, options))) {
             mz_zip_reader_end(&zip);
             return CRASH(future, "Couldn't initialize a zip writer.");
         }
     } else {
-        if (!mz_zip_writer_init_file_v2(&zip, destinationZipPath.toUtf8().constData(), 0, 0))
+        if (!mz_zip_writer_init_file_v2(&zip, destinationZipPath.toUtf8().constData(), 0,
+                                        writerFlags(&zip, options)))
             return CRASH(future, "Couldn't initialize a zip writer.");
     }
 
     // Compressing and adding entries
-    for (size_t i = 1; i < vector->size(); ++i) {
-        const QString& path = sourceIsAFile ? sourcePath : (sourcePath + vector->at(i));
-        const bool isDir = QFileInfo(path).isDir();
-        const QByteArray& archivePath = sourceIsAFile
-                ? cleanArchivePath(rootDirectory, QFileInfo(sourcePath).fileName())
-                : cleanArchivePath(rootDirectory, vector->at(i), isDir);
-
-        if (isDir) {
-            if (!mz_zip_writer_add_mem(&zip, archivePath.constData(), nullptr, 0, 0)) {
-                mz_zip_writer_finalize_archive(&zip);
-                mz_zip_writer_end(&zip);
-                return CRASH(future, "Couldn't add a directory entry for: %1.", path);
-            }
+    QScopedPointer<CompressionQueue> queue;
+    QScopedPointer<StoringPool> storingPool;
+    size_t nextToSchedule = 0;
+    size_t entryCount = 0;
+    quint64 namesSize = 0;
+    bool reserved = false;
+    QByteArray relativePath;
+    QByteArray archivePath;
+    const QByteArray& root = cleanRootDirectory(rootDirectory);
+    const bool useStoringPool = options & ParallelCompression && !sourceIsAFile
+                                && compressionLevel == NoCompression;
+    if (options & ParallelCompression && !sourceIsAFile && compressionLevel != NoCompression)
+        queue.reset(new CompressionQueue);
+
+    while (!window.empty()) {
+        if (storingPool && storingPool->failed())
+            break;
+        if (scanner)
+            reserveCentralDirectory(&zip, scanner.data(), root, entryCount, namesSize, &reserved);
+        if (queue)
+            nextToSchedule = scheduleCompression(queue.data(), scanner.data(), window, sourcePath,
+                                                 compressionLevel, nextToSchedule);
+
+        const ResolvedEntry entry(std::move(window.front()));
+        window.pop_front();
+        if (nextToSchedule > 0)
+            --nextToSchedule;
+
+        if (sourceIsAFile) {
+            archivePath = cleanArchivePath(rootDirectory, QFileInfo(sourcePath).fileName());
         } else {
-            if (!mz_zip_writer_add_file(&zip, archivePath, path.toUtf8().constData(),
-                                        nullptr, 0, compressionLevel)) {
+            scanner->relativePath(entry, &relativePath);
+            makeArchivePath(root, relativePath, entry.isDir, &archivePath);
+        }
+        const QString& path = sourceIsAFile ? sourcePath : (sourcePath + QString::fromUtf8(relativePath));
+
+        if (entry.scheduled) {
+            CompressedEntry compressedEntry(queue->dequeue());
+            if (compressedEntry.failed
+                    || !addCompressedEntry(&zip, archivePath, &compressedEntry, compressionLevel)) {
                 mz_zip_writer_finalize_archive(&zip);
                 mz_zip_writer_end(&zip);
                 return CRASH(future, "Couldn't compress the file: %1.", path);
             }
+        } else {
+            if (entry.isDir) {
+                if (!mz_zip_writer_add_mem(&zip, archivePath.constData(), nullptr, 0, 0)) {
+                    if (storingPool)
+                        storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    // Cut off the data of the files the storing pool dropped
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return CRASH(future, "Couldn't add a directory entry for: %1.", path);
+                }
+            } else if (useStoringPool && entry.size >= MIN_POOLED_STORE_SIZE) {
+                if (!storingPool)
+                    storingPool.reset(new StoringPool(destinationZipPath, future));
+                mz_uint64 dataOffset;
+                if (!mz_zip_writer_add_reserved_file(&zip, archivePath.constData(), entry.size,
+                                                     &entry.lastModified, &dataOffset)) {
+                    storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return CRASH(future, "Couldn't compress the file: %1.", path);
+                }
+                storingPool->enqueue(path, zip.m_total_files - 1, dataOffset, entry.size);
+            } else {
+                if (!addFile(&zip, archivePath, path, entry.size, entry.lastModified,
+                             compressionLevel, options, future)) {
+                    if (storingPool)
+                        storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    // Cut off the partially written entry
+                    QFile::resize(destinationZipPath, archiveSize);
+                    if (future->isCanceled())
+                        return 0;
+                    return CRASH(future, "Couldn't compress the file: %1.", path);
+                }
+            }
         }
+        ++entryCount;
+        namesSize += archivePath.size();
+
+        // Wait for the scanner, if the writer caught up with it, staying responsive meanwhile
+        do {
+            const size_t discoveredCount = sourceIsAFile ? 1 : scanner->discoveredCount();
+            if (discoveredCount != reportedCount && future->isProgressUpdateNeeded())
+                future->reportResult(reportedCount = discoveredCount);
+            if (!storingPool) {
+                REPORT_PROGRESS_SAFE(1 + 98. * entryCount / discoveredCount, zip)
+            } else if (future->isProgressUpdateNeeded()) {
+                // Same, but the workers must be done before pausing or finalizing
+                if (future->isPaused()) {
+                    storingPool->finish(&zip);
+                    future->waitForResume();
+                }
+                if (future->isCanceled()) {
+                    storingPool->finish(&zip);
+                    mz_zip_writer_finalize_archive(&zip);
+                    const mz_uint64 archiveSize = zip.m_archive_size;
+                    mz_zip_writer_end(&zip);
+                    QFile::resize(destinationZipPath, archiveSize);
+                    return 0;
+                }
+                future->setProgressValue(1 + 98. * entryCount / discoveredCount);
+            }
 
-        progress += step;
-        REPORT_PROGRESS_SAFE(progress, zip)
+            ResolvedEntry nextEntry;
+            if (window.empty() && scanner && scanner->take(&nextEntry, 40))
+                window.push_back(std::move(nextEntry));
+        } while (window.empty() && scanner && !scanner->atEnd());
     }
 
     // Archive finalization
+    if (storingPool && !storingPool->finish(&zip)) {
+        mz_zip_writer_finalize_archive(&zip);
+        const mz_uint64 archiveSize = zip.m_archive_size;
+        mz_zip_writer_end(&zip);
+        // Cut off the files that couldn't be stored
+        QFile::resize(destinationZipPath, archiveSize);
+        if (future->isCanceled())
+            return 0;
+        return CRASH(future, "Couldn't compress the file: %1.", storingPool->failedFilePath());
+    }
     if (!mz_zip_writer_finalize_archive(&zip)) {
         mz_zip_writer_end(&zip);
         return CRASH(future, "Couldn't finalize the zip writer.");
@@ -349,7 +2090,7 @@ size_t zip(QFutureInterfaceBase* futureInterface, const QString& sourcePath,
     if (!mz_zip_writer_end(&zip))
         return CRASH(future, "Couldn't clean the zip writer cache.");
 
-    FINALIZE(vector->size() - 1)
+    FINALIZE(entryCount)
 }
 
 size_t unzip(QFutureInterfaceBase* futureInterface, const QString& sourceZipPath,
@@ -361,8 +2102,10 @@ size_t unzip(QFutureInterfaceBase* futureInterface, const QString& sourceZipPath
     QString sourceZipFinalPath(sourceZipPath);
     copyResourceFile(sourceZipFinalPath, tempDir);
 
+    Arena arena;
     mz_zip_archive zip;
     memset(&zip, 0, sizeof(zip));
+    arena.install(&zip);
     if (!mz_zip_reader_init_file_v2(&zip, sourceZipFinalPath.toUtf8().constData(), 0, 0, 0))
         return CRASH(future, "Couldn't initialize a zip reader.");
 
@@ -374,66 +2117,82 @@ size_t unzip(QFutureInterfaceBase* futureInterface, const QString& sourceZipPath
         return CRASH(future, "The archive is either invalid or empty.");
     }
 
-    // Iterate for dirs
+    // Scan the central directory once
+    std::vector<mz_zip_archive_entry_view> entries(numberOfEntries);
     for (mz_uint i = 0; i < numberOfEntries; ++i) {
-        mz_zip_archive_file_stat fileStat;
-        if (!mz_zip_reader_file_stat(&zip, i, &fileStat)) {
+        if (!mz_zip_reader_entry_view(&zip, i, &entries[i])) {
             mz_zip_reader_end(&zip);
             return CRASH(future, "Archive is broken.");
         }
-        if (!fileStat.m_is_supported) {
+        if (!entries[i].m_is_supported) {
             mz_zip_reader_end(&zip);
             return CRASH(future, "Archive isn't supported.");
         }
-        if (fileStat.m_is_directory) {
+    }
+
+    // Create dirs (including parent dirs of files) and collect files
+    QSet<QString> createdPaths;
+    std::vector<mz_zip_archive_entry_view> files;
+    files.reserve(numberOfEntries);
+    for (const mz_zip_archive_entry_view& entry : entries) {
+        const QString& name = entryName(entry);
+        if (entry.m_is_directory) {
             if (!overwrite) {
-                const bool isBase = QString(fileStat.m_filename).count('/') <= 1;
-                if (isBase && QFileInfo::exists(destinationPath + '/' + fileStat.m_filename)) {
+                const bool isBase = name.count('/') <= 1;
+                if (isBase && !createdPaths.contains(name.left(name.size() - 1))
+                        && QFileInfo::exists(destinationPath + '/' + name)) {
                     mz_zip_reader_end(&zip);
                     return CRASH(future, "Extraction canceled, dir already exists: %1.",
-                          destinationPath + '/' + fileStat.m_filename);
+                          destinationPath + '/' + name);
                 }
             }
-            if (!QDir(destinationPath).mkpath(fileStat.m_filename)) {
+            if (!makePath(destinationPath, name, &createdPaths)) {
                 mz_zip_reader_end(&zip);
                 return CRASH(future, "Directory creation on disk is failed for: %1.",
-                      destinationPath + '/' + fileStat.m_filename);
+                      destinationPath + '/' + name);
             }
             processedEntryCount++;
             REPORT_PROGRESS_SAFE(100 * processedEntryCount / numberOfEntries, zip)
-        }
-    }
-
-    // Iterate for files
-    for (mz_uint i = 0; i < numberOfEntries; ++i) {
-        mz_zip_archive_file_stat fileStat;
-        if (!mz_zip_reader_file_stat(&zip, i, &fileStat)) {
-            mz_zip_reader_end(&zip);
-            return CRASH(future, "Archive is broken.");
-        }
-        if (!fileStat.m_is_supported) {
-            mz_zip_reader_end(&zip);
-            return CRASH(future, "Archive isn't supported.");
-        }
-        if (!fileStat.m_is_directory) {
+        } else {
             if (!overwrite) {
-                const bool isBase = QString(fileStat.m_filename).count('/') < 1;
-                if (isBase && QFileInfo::exists(destinationPath + '/' + fileStat.m_filename)) {
+                const bool isBase = name.count('/') < 1;
+                if (isBase && QFileInfo::exists(destinationPath + '/' + name)) {
                     mz_zip_reader_end(&zip);
                     return CRASH(future, "Extraction canceled, file already exists: %1.",
-                          destinationPath + '/' + fileStat.m_filename);
+                          destinationPath + '/' + name);
                 }
             }
-            if (!mz_zip_reader_extract_to_file(
-                        &zip, i, (destinationPath + '/' + fileStat.m_filename).toUtf8().constData(),
-                        0)) {
+            const QString& parent = name.left(qMax(0, name.lastIndexOf('/')));
+            if (!makePath(destinationPath, parent, &createdPaths)) {
                 mz_zip_reader_end(&zip);
-                return CRASH(future, "Extraction failed, file: %1.",
-                      destinationPath + '/' + fileStat.m_filename);
+                return CRASH(future, "Directory creation on disk is failed for: %1.",
+                      destinationPath + '/' + parent);
             }
-            processedEntryCount++;
-            REPORT_PROGRESS_SAFE(100 * processedEntryCount / numberOfEntries, zip)
+            files.push_back(entry);
+        }
+    }
+
+    // Extract files in parallel, while reporting the progress from here
+    if (!files.empty()) {
+        ExtractionPool pool(&zip, destinationPath, files, future);
+        while (!pool.waitForDone(40)) {
+            // Workers share the zip reader, so it's only released once they're stopped
+            if (future->isProgressUpdateNeeded()) {
+                if (future->isPaused())
+                    future->waitForResume();
+                if (!future->isCanceled())
+                    future->setProgressValue(100 * (processedEntryCount + pool.extractedCount()) / numberOfEntries);
+            }
+        }
+        if (future->isCanceled()) {
+            mz_zip_reader_end(&zip);
+            return 0;
+        }
+        if (pool.failed()) {
+            mz_zip_reader_end(&zip);
+            return CRASH(future, "Extraction failed, file: %1.", pool.failedFilePath());
         }
+        processedEntryCount += pool.extractedCount();
     }
 
     if (!mz_zip_reader_end(&zip))
@@ -442,11 +2201,94 @@ size_t unzip(QFutureInterfaceBase* futureInterface, const QString& sourceZipPath
     FINALIZE(processedEntryCount)
 }
 
+size_t zipToDeviceSync(const QList<ZipEntry>& entries, QIODevice* destination,
+                       CompressionLevel compressionLevel, ZipOptions options)
+{
+    if (entries.isEmpty())
+        return WARNING("Nothing to compress, no entries given.");
+
+    // miniz rewrites local headers once an entry is added, so sequential devices get a copy
+    QByteArray buffer;
+    QBuffer bufferDevice(&buffer);
+    QIODevice* device = destination;
+    if (destination->isSequential()) {
+        bufferDevice.open(QIODevice::WriteOnly);
+        device = &bufferDevice;
+    }
+
+    DeviceOutput output = {device, device->pos()};
+    Arena arena;
+    mz_zip_archive zip;
+    memset(&zip, 0, sizeof(zip));
+    arena.install(&zip);
+    zip.m_pWrite = writeToDevice;
+    zip.m_pIO_opaque = &output;
+
+    // Archive initialization
+    if (!mz_zip_writer_init_v2(&zip, 0, writerFlags(&zip, options)))
+        return WARNING("Couldn't initialize a zip writer.");
+
+    quint64 namesSize = 0;
+    for (const ZipEntry& entry : entries)
+        namesSize += entry.archivePath.toUtf8().size();
+    mz_zip_writer_reserve_central_dir(&zip, entries.size(), namesSize);
+
+    // Compressing and adding entries
+    QScopedPointer<CompressionQueue> queue;
+    std::vector<bool> scheduled(entries.size(), false);
+    int nextToSchedule = 0;
+    if (options & ParallelCompression)
+        queue.reset(new CompressionQueue);
+
+    for (int i = 0; i < entries.size(); ++i) {
+        const ZipEntry& entry = entries.at(i);
+        const QByteArray& archivePath = entry.archivePath.toUtf8();
+
+        if (queue)
+            nextToSchedule = scheduleCompression(queue.data(), entries, scheduled,
+                                                 compressionLevel, nextToSchedule);
+
+        bool added;
+        if (scheduled[i]) {
+            CompressedEntry compressedEntry(queue->dequeue());
+            added = !compressedEntry.failed
+                    && addCompressedEntry(&zip, archivePath, &compressedEntry, compressionLevel);
+        } else if (entry.device) {
+            added = addDevice(&zip, archivePath, entry.device, lastModifiedTime(entry), compressionLevel);
+        } else {
+            MZ_TIME_T lastModified = lastModifiedTime(entry);
+            added = mz_zip_writer_add_mem_ex_v2(&zip, archivePath, entry.data.constData(), entry.data.size(),
+                                                nullptr, 0, compressionLevel, 0, 0, &lastModified,
+                                                nullptr, 0, nullptr, 0);
+        }
+
+        if (!added) {
+            mz_zip_writer_finalize_archive(&zip);
+            mz_zip_writer_end(&zip);
+            return WARNING("Couldn't compress the entry: %s.", archivePath.constData());
+        }
+    }
+
+    // Archive finalization
+    if (!mz_zip_writer_finalize_archive(&zip)) {
+        mz_zip_writer_end(&zip);
+        return WARNING("Couldn't finalize the zip writer.");
+    }
+    if (!mz_zip_writer_end(&zip))
+        return WARNING("Couldn't clean the zip writer cache.");
+
+    if (device != destination && destination->write(buffer) != buffer.size())
+        return WARNING("Couldn't write the archive into the destination device.");
+
+    return entries.size();
+}
+
 } // Internal
 
 size_t zipSync(const QString& sourcePath, const QString& destinationZipPath,
                const QString& rootDirectory, CompressionLevel compressionLevel,
-               QDir::Filters filters, const QStringList& nameFilters, bool append)
+               QDir::Filters filters, const QStringList& nameFilters, bool append,
+               ZipOptions options)
 {
     if (!QFileInfo::exists(sourcePath)) {
         qWarning("WARNING: The source path doesn't exist");
@@ -479,7 +2321,7 @@ size_t zipSync(const QString& sourcePath, const QString& destinationZipPath,
     filters |= QDir::NoDotAndDotDot;
 
     return Internal::zipSync(sourcePath, destinationZipPath, rootDirectory,
-                             nameFilters, filters, compressionLevel, append);
+                             nameFilters, filters, compressionLevel, append, options);
 }
 
 size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, bool overwrite)
@@ -517,6 +2359,57 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
     return Internal::unzipSync(sourceZipPath, destinationPath, overwrite);
 }
 
+/*!
+    Summary:
+        This function compresses the given in-memory entries into a zip archive and returns the
+        finalized archive, without touching the disk. Each entry is either a chunk of data or a
+        device (e.g. a QBuffer or a QFile) to read from, the whole content of a device is added.
+        Archive paths are relative paths, the ones ending with a slash are directory entries (with
+        no data). If an entry doesn't specify its modification time, the current time is used.
+        The function returns an empty QByteArray if it fails.
+
+    compressionLevel:
+        Same as the compressionLevel parameter of the zip function.
+
+    options:
+        Same as the options parameter of the zip function. Data entries are compressed on
+        separate cores when the ParallelCompression option is set, devices are read from the
+        calling thread.
+*/
+QByteArray zipToMemorySync(const QList<ZipEntry>& entries, CompressionLevel compressionLevel,
+                           ZipOptions options)
+{
+    QByteArray archive;
+    QBuffer buffer(&archive);
+    buffer.open(QIODevice::WriteOnly);
+    if (!zipToDeviceSync(entries, &buffer, compressionLevel, options))
+        return QByteArray();
+    return archive;
+}
+
+/*!
+    Summary:
+        Same as the zipToMemorySync function, but writes the archive into the given destination
+        device (opened for writing) from its current position, instead of returning it. Random
+        access devices are written in place, while the archive is buffered in memory first for
+        sequential ones (e.g. sockets). Returns the number of entries compressed, or 0 if fails.
+*/
+size_t zipToDeviceSync(const QList<ZipEntry>& entries, QIODevice* destination,
+                       CompressionLevel compressionLevel, ZipOptions options)
+{
+    if (!destination) {
+        qWarning("WARNING: The destination device is null");
+        return 0;
+    }
+
+    if (!destination->isWritable()) {
+        qWarning("WARNING: The destination device isn't writable");
+        return 0;
+    }
+
+    return Internal::zipToDeviceSync(entries, destination, compressionLevel, options);
+}
+
 /*!
     Summary:
         This function compresses, depending on the sourcePath, the file or recursive content of the
@@ -541,18 +2434,18 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
         QObject::tr() function (which means you can use Qt Linguist Tools (lupdate etc) on this cpp
         file in order to extract out the original English written error strings to translate).
 
-        The zip operation occurs in 2 phases. In the first phase, the files and folders are resolved
-        recursively within the sourcePath. And while the first phase is still in progress, the
-        resultReadyAt signal is emitted almost 25 times per second with the total number of entries
-        resolved so far. After the resolution is done and all the files and folders are resolved,
-        the total number of all the resolved files and folders will be reported (resultReadyAt)
-        alongside the progress value will be set to %1 (progressValueChanged will be emitted). After
-        this point, the second phase starts. In the second phase, resolved files and folders are
-        started to be compressed (on the heap if overwrite isn't going to happen, otherwise every
-        compression cycle will be saved immediately into the zip archive on the disk that is being
-        overwritten). At this point, for each cycle of the compression, the progressValueChanged
-        signal is emitted almost 25 times per second with the appropriate progress values of the
-        ongoing compression operation and the progress range for the operation is between 0 and 100.
+        The files and folders within the sourcePath are resolved recursively on a separate thread,
+        while the ones resolved so far are already being compressed, so the compression starts as
+        soon as the first entry is found. When the first entry is resolved, the number of entries
+        discovered so far will be reported (resultReadyAt) alongside the progress value will be set
+        to %1 (progressValueChanged will be emitted). After this point, while the operation is in
+        progress, the resultReadyAt signal is emitted almost 25 times per second with the number of
+        entries discovered so far, whenever it grows. Every compression cycle is saved immediately
+        into the zip archive on the disk. At this point, for each cycle of the compression, the
+        progressValueChanged signal is emitted almost 25 times per second with the appropriate
+        progress values of the ongoing compression operation (relative to the entries discovered
+        so far, so it may stall while new entries are being discovered) and the progress range for
+        the operation is between 0 and 100.
         (Progress reporting may freezes for some time until, for instance, a big chunk of file is
         being completely compressed) When the operation is finished, the finished signal is emitted
         alongside with the progressValueChanged signal that the progress value is set to 100. As we
@@ -628,10 +2521,33 @@ size_t unzipSync(const QString& sourceZipPath, const QString& destinationPath, b
         not. This option is similar to the affect of QIODevice::Append on the QFile::open function.
         If destinationZipPath parameter points out to a nonexistent file, then append option doesn't
         have any effect.
+
+    options:
+        This parameter is used to enable optional zipping behaviors, none of which is enabled by
+        default. If ParallelCompression is set, files are compressed concurrently on a separate
+        pool of threads (one thread per processor core) while the entries are still written into
+        the zip archive one by one, in the same order they are resolved. Hence the resulting zip archive is the same as the one created
+        without this option. Big files (more than 8 MiB) aren't held in memory, they are split into
+        1 MiB blocks instead, which are deflated on separate cores and stitched together into a
+        single deflate stream (each block is primed with the 32 KiB of data preceding it, so the
+        compression ratio stays almost the same). This applies to a single file source as well.
+        It costs up to 64 MiB of pending source data, plus an input buffer kept by each thread of
+        the pool. With NoCompression, files of 1 MiB or more are copied in by a pool of threads.
+        If AlignStoredData is set, the data of each stored entry (e.g. with NoCompression) starts
+        at a 4 KiB boundary of the archive, so a memory mapped archive (see ZipArchive) can hand
+        it out in place, the same way zipalign does for Android packages. The local header of such
+        an entry is padded with an extra field, which zip tools ignore.
+        If ParallelDecompression is set, big files are deflated in blocks as well, but each block
+        on its own (not primed, it costs about 0.1% of compression ratio), and the compressed size
+        of each block is recorded in an extra field of the entry's central directory record, which
+        lets unzip() inflate the blocks of a single file on separate cores. The blocks are 1 MiB
+        (bigger for files of more than 8 GiB, to keep the index within 32 KiB). Other zip tools
+        ignore the field and read such an entry as a single deflate stream.
 */
 QFuture<size_t> zip(const QString& sourcePath, const QString& destinationZipPath,
                     const QString& rootDirectory, CompressionLevel compressionLevel,
-                    QDir::Filters filters, const QStringList& nameFilters, bool append)
+                    QDir::Filters filters, const QStringList& nameFilters, bool append,
+                    ZipOptions options)
 {
     if (!QFileInfo::exists(sourcePath)) {
         qWarning("WARNING: The source path doesn't exist");
@@ -664,7 +2580,7 @@ QFuture<size_t> zip(const QString& sourcePath, const QString& destinationZipPath
     filters |= QDir::NoDotAndDotDot;
 
     return Async::run(QThreadPool::globalInstance(), Internal::zip, sourcePath, destinationZipPath,
-                      rootDirectory, nameFilters, filters, compressionLevel, append);
+                      rootDirectory, nameFilters, filters, compressionLevel, append, options);
 }
 
 /*!
@@ -698,6 +2614,11 @@ QFuture<size_t> zip(const QString& sourcePath, const QString& destinationZipPath
         may also be used at any arbitrary point in the operation's life time in order to pause/resume
         or cancel the operation. Appropriate signals will also be emitted.
 
+        Directories are created first, then files are extracted concurrently on a separate pool of
+        threads (one thread per processor core), all reading the same opened zip archive. Files
+        zipped with the ParallelDecompression option are split up further, each of their blocks
+        is inflated on its own, so a single big file is extracted on all the cores as well.
+
         There will be no additional limitations arising from the use of this library on compressed
         or extracted archive files. If there are any limitations that you encounter, this will be
         due to the "miniz" library, which we use as the base implementation. (Limitations such as
@@ -753,4 +2674,182 @@ QFuture<size_t> unzip(const QString& sourceZipPath, const QString& destinationPa
     return Async::run(QThreadPool::globalInstance(), Internal::unzip,
                       sourceZipPath, destinationPath, overwrite);
 }
+
+struct ZipArchive::Private
+{
+    // Returns the seek state of the entry, creating it on first access, or null if not found
+    mz_zip_reader_seek_state* seekState(const QString& archivePath, mz_zip_archive_entry_view* view)
+    {
+        const int index = mz_zip_reader_locate_file(&zip, archivePath.toUtf8().constData(), nullptr, 0);
+        if (index < 0 || !mz_zip_reader_entry_view(&zip, mz_uint(index), view))
+            return nullptr;
+
+        mz_zip_reader_seek_state* state = seekStates.value(mz_uint(index));
+        if (!state) {
+            state = mz_zip_reader_seek_new(&zip, mz_uint(index), mz_uint64(checkpointInterval));
+            if (state)
+                seekStates.insert(mz_uint(index), state);
+        }
+        return state;
+    }
+
+    QFile file;
+    mz_zip_archive zip;
+    bool open;
+    qint64 checkpointInterval;
+    QMutex mutex;
+    QHash<mz_uint, mz_zip_reader_seek_state*> seekStates;
+};
+
+/*!
+    Summary:
+        Memory maps the zip archive at zipPath and reads its central directory, the archive stays
+        mapped until the object is destroyed. Check isOpen() to see if it succeeded. Member
+        functions are thread safe, reads from the same archive are serialized though.
+
+    checkpointInterval:
+        Compressed entries are read from the closest checkpoint before the offset read, recorded
+        at the first deflate block start every checkpointInterval bytes of the entry, the first
+        time a read gets past them. Each checkpoint takes about 32 KiB of memory, a read costs
+        about checkpointInterval bytes of inflating (a few milliseconds per MiB).
+*/
+ZipArchive::ZipArchive(const QString& zipPath, qint64 checkpointInterval) : d(new Private)
+{
+    memset(&d->zip, 0, sizeof(d->zip));
+    d->open = false;
+    d->checkpointInterval = checkpointInterval;
+    d->file.setFileName(zipPath);
+
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        WARNING("Couldn't open the zip archive.");
+        return;
+    }
+
+    const uchar* mapping = d->file.map(0, d->file.size());
+    if (!mapping) {
+        WARNING("Couldn't map the zip archive.");
+        return;
+    }
+
+    d->open = mz_zip_reader_init_mem(&d->zip, mapping, size_t(d->file.size()), 0);
+    if (!d->open)
+        WARNING("Couldn't initialize a zip reader.");
+}
+
+ZipArchive::~ZipArchive()
+{
+    for (mz_zip_reader_seek_state* state : d->seekStates)
+        mz_zip_reader_seek_free(state);
+    if (d->open)
+        mz_zip_reader_end(&d->zip);
+}
+
+bool ZipArchive::isOpen() const
+{
+    return d->open;
+}
+
+/*!
+    Summary:
+        Returns the data of the stored (not compressed) entry at archivePath without copying it,
+        the returned QByteArray points into the mapping of the archive, so it must not outlive the
+        ZipArchive. Returns a null QByteArray if there is no such entry, or if it is compressed.
+        Zip archives written with the AlignStoredData option have the data page aligned.
+*/
+QByteArray ZipArchive::storedData(const QString& archivePath) const
+{
+    if (!d->open)
+        return QByteArray();
+
+    QMutexLocker locker(&d->mutex);
+    const int index = mz_zip_reader_locate_file(&d->zip, archivePath.toUtf8().constData(), nullptr, 0);
+    const void* data;
+    size_t size;
+    if (index < 0 || !mz_zip_reader_get_stored_file_data(&d->zip, mz_uint(index), &data, &size)
+            || size > size_t(std::numeric_limits<int>::max())) {
+        return QByteArray();
+    }
+
+    return QByteArray::fromRawData(static_cast<const char*>(data), int(size));
+}
+
+/*!
+    Summary:
+        Returns size bytes of the entry at archivePath from the given offset on (less if the entry
+        ends before), decompressing only what is needed to get there (see checkpointInterval).
+        Reads going forward from where the previous one ended continue from there. The data isn't
+        CRC checked. Returns a null QByteArray if there is no such entry or the offset is past it.
+*/
+QByteArray ZipArchive::read(const QString& archivePath, qint64 offset, qint64 size) const
+{
+    if (!d->open || offset < 0 || size <= 0)
+        return QByteArray();
+
+    QMutexLocker locker(&d->mutex);
+    mz_zip_archive_entry_view view;
+    mz_zip_reader_seek_state* state = d->seekState(archivePath, &view);
+    if (!state || quint64(offset) >= view.m_uncomp_size)
+        return QByteArray();
+
+    size = qMin(size, qint64(view.m_uncomp_size - quint64(offset)));
+    if (size > std::numeric_limits<int>::max())
+        return QByteArray();
+
+    QByteArray data;
+    data.resize(int(size));
+    if (mz_zip_reader_seek_read(state, quint64(offset), data.data(), size_t(size)) != size_t(size))
+        return QByteArray();
+
+    return data;
+}
+
+/*!
+    Summary:
+        Returns the checkpoints of the compressed entry at archivePath, recording the ones missing
+        first (by decompressing the rest of the entry), so they can be persisted and handed to
+        restoreCheckpoints() the next time the archive is opened, to skip recording them again.
+        Returns a null QByteArray for stored entries, which don't need checkpoints.
+*/
+QByteArray ZipArchive::checkpoints(const QString& archivePath) const
+{
+    if (!d->open)
+        return QByteArray();
+
+    QMutexLocker locker(&d->mutex);
+    mz_zip_archive_entry_view view;
+    mz_zip_reader_seek_state* state = d->seekState(archivePath, &view);
+    if (!state || !view.m_method || !view.m_uncomp_size)
+        return QByteArray();
+
+    char last;
+    if (!mz_zip_reader_seek_read(state, view.m_uncomp_size - 1, &last, 1))
+        return QByteArray();
+
+    const size_t size = mz_zip_reader_seek_save_checkpoints(state, nullptr, 0);
+    if (size > size_t(std::numeric_limits<int>::max()))
+        return QByteArray();
+
+    QByteArray checkpoints;
+    checkpoints.resize(int(size));
+    mz_zip_reader_seek_save_checkpoints(state, checkpoints.data(), size);
+    return checkpoints;
+}
+
+/*!
+    Summary:
+        Restores the checkpoints of the entry at archivePath from the ones returned by
+        checkpoints() for the same entry. Returns false if they're damaged or don't match the
+        entry. Checkpoints only hold positions in the entry and the data before them, so forged
+        ones can make reads fail or return wrong data, but can't do any harm beyond that.
+*/
+bool ZipArchive::restoreCheckpoints(const QString& archivePath, const QByteArray& checkpoints)
+{
+    if (!d->open)
+        return false;
+
+    QMutexLocker locker(&d->mutex);
+    mz_zip_archive_entry_view view;
+    mz_zip_reader_seek_state* state = d->seekState(archivePath, &view);
+    return state && mz_zip_reader_seek_load_checkpoints(state, checkpoints.constData(), size_t(checkpoints.size()));
+}
 } // ZipAsync
@@ -26,6 +26,8 @@
 #include "zipasync_global.h"
 #include <QFuture>
 #include <QDir>
+#include <QDateTime>
+#include <QScopedPointer>
 
 namespace ZipAsync {
 
@@ -39,20 +41,75 @@ enum CompressionLevel {
     Ultra         = 10
 };
 
+enum ZipOption {
+    NoZipOptions          = 0x0,
+    ParallelCompression   = 0x1,
+    AlignStoredData       = 0x2,
+    ParallelDecompression = 0x4
+};
+Q_DECLARE_FLAGS(ZipOptions, ZipOption)
+
+// An in-memory source for an entry, either data or a device to read (as a whole) from
+struct ZipEntry
+{
+    ZipEntry(const QString& archivePath, const QByteArray& data,
+             const QDateTime& lastModified = QDateTime())
+        : archivePath(archivePath), data(data), device(nullptr), lastModified(lastModified) {}
+
+    ZipEntry(const QString& archivePath, QIODevice* device,
+             const QDateTime& lastModified = QDateTime())
+        : archivePath(archivePath), device(device), lastModified(lastModified) {}
+
+    QString archivePath;
+    QByteArray data;
+    QIODevice* device;
+    QDateTime lastModified;
+};
+
 size_t ZIPASYNC_EXPORT zipSync(const QString& sourcePath, const QString& destinationZipPath,
                                const QString& rootDirectory = QString(), CompressionLevel compressionLevel = Medium,
                                QDir::Filters filters = QDir::NoFilter, const QStringList& nameFilters = {},
-                               bool append = true);
+                               bool append = true, ZipOptions options = NoZipOptions);
 
 size_t ZIPASYNC_EXPORT unzipSync(const QString& sourceZipPath, const QString& destinationPath, bool overwrite = false);
 
+QByteArray ZIPASYNC_EXPORT zipToMemorySync(const QList<ZipEntry>& entries, CompressionLevel compressionLevel = Medium,
+                                           ZipOptions options = NoZipOptions);
+
+size_t ZIPASYNC_EXPORT zipToDeviceSync(const QList<ZipEntry>& entries, QIODevice* destination,
+                                       CompressionLevel compressionLevel = Medium,
+                                       ZipOptions options = NoZipOptions);
+
 QFuture<size_t> ZIPASYNC_EXPORT zip(const QString& sourcePath, const QString& destinationZipPath,
                                     const QString& rootDirectory = QString(), CompressionLevel compressionLevel = Medium,
                                     QDir::Filters filters = QDir::NoFilter, const QStringList& nameFilters = {},
-                                    bool append = true);
+                                    bool append = true, ZipOptions options = NoZipOptions);
 
 QFuture<size_t> ZIPASYNC_EXPORT unzip(const QString& sourceZipPath, const QString& destinationPath, bool overwrite = false);
 
+// A zip archive memory mapped for reading, its stored entries are accessed in place (zero-copy)
+// and any entry can be read from an arbitrary offset
+class ZIPASYNC_EXPORT ZipArchive final
+{
+    Q_DISABLE_COPY(ZipArchive)
+
+public:
+    explicit ZipArchive(const QString& zipPath, qint64 checkpointInterval = 4 * 1024 * 1024);
+    ~ZipArchive();
+
+    bool isOpen() const;
+    QByteArray storedData(const QString& archivePath) const;
+    QByteArray read(const QString& archivePath, qint64 offset, qint64 size) const;
+    QByteArray checkpoints(const QString& archivePath) const;
+    bool restoreCheckpoints(const QString& archivePath, const QByteArray& checkpoints);
+
+private:
+    struct Private;
+    QScopedPointer<Private> d;
+};
+
 } // ZipAsync
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(ZipAsync::ZipOptions)
+
 #endif // ZIPASYNC_H